@@ -0,0 +1,616 @@
+/*
+ * A display daemon for Linux.  The framebuffer lives in a memfd that
+ * clients map and draw into directly; they post damage rectangles over
+ * a Unix socket (see linux_fbd.h).  Damage from all clients is merged
+ * into per-page column ranges (struct ssd1306_damage), flushed at most
+ * once per interval, and each client is told when its damage is on the
+ * panel.  A flush that fails is retried at the next interval.  SIGUSR1
+ * (and exiting) prints per-client latency and how busy the bus was.
+ *
+ *	c++ -std=c++11 -c lib/ssd1306.cpp lib/ssd1306_c.cpp lib/ssd1306_panel.cpp \
+ *		lib/ssd1306_compositor.cpp
+ *	cc -std=c99 -Ilib examples/linux_fbd.c examples/ssd1306_sim.c \
+ *		ssd1306.o ssd1306_c.o ssd1306_panel.o ssd1306_compositor.o \
+ *		-o linux_fbd
+ *	./linux_fbd [-t sim[:bus_hz] | -t i2c:/dev/i2c-1[:addr]]
+ *		[-p panel] [-o degrees] [-i interval_ms] [-s socket] [-x]
+ *
+ * -x exits once the last client has gone and everything is flushed.
+ * With the simulator it then checks GDDRAM against the framebuffer,
+ * which makes it usable as a test (see linux_fbd_client.c).
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/i2c-dev.h>
+#include "ssd1306_sim.h"
+#include "ssd1306.h"
+#include "ssd1306_compositor.h"
+#include "linux_fbd.h"
+
+#define MAX_CLIENTS 16
+
+static const struct {
+	const char *name;
+	enum ssd1306_screen_type type;
+} panels[] = {
+	{ "128x32", ssd1306_128_32 },
+	{ "128x64", ssd1306_128_64 },
+	{ "96x16", ssd1306_96_16 },
+	{ "64x48", ssd1306_64_48 },
+	{ "72x40", ssd1306_72_40 },
+	{ "sh1106", sh1106_128_64 },
+	{ "ssd1309", ssd1309_128_64 },
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+
+
+/*
+ * Transports.  Each is a write function and its connection info; the
+ * daemon wraps whichever one is picked to count bytes and busy time.
+ */
+struct transport {
+	const char *name;
+	ssd1306_write_fn write;
+	void *conn;
+};
+
+/* The simulated controller, taking as long as an I2C bus at hz would */
+struct sim_link {
+	ssd1306_sim sim;
+	uint32_t hz;
+};
+
+static bool sim_link_write(void *conn_info, const uint8_t *buffer,
+			   size_t size, bool is_cmd)
+{
+	struct sim_link *link = (struct sim_link *)conn_info;
+	bool ok = ssd1306_sim_write(&link->sim, buffer, size, is_cmd);
+
+	if (link->hz) {
+		/* Address and control byte, then the payload, 9 clocks each */
+		uint64_t ns = (uint64_t)(size + 2) * 9 * 1000000000u / link->hz;
+		struct timespec ts = { (time_t)(ns / 1000000000u),
+				       (long)(ns % 1000000000u) };
+		while (nanosleep(&ts, &ts) && errno == EINTR)
+			;
+	}
+	return ok;
+}
+
+/* /dev/i2c-N through i2c-dev, a control byte in front of each transfer */
+struct i2c_link {
+	int fd;
+	uint8_t buf[1 + SSD1306_MAX_GDDRAM];
+};
+
+static bool i2c_link_write(void *conn_info, const uint8_t *buffer,
+			   size_t size, bool is_cmd)
+{
+	struct i2c_link *link = (struct i2c_link *)conn_info;
+
+	while (size) {
+		size_t n = size < SSD1306_MAX_GDDRAM ? size : SSD1306_MAX_GDDRAM;
+		link->buf[0] = is_cmd ? 0x00 : 0x40;
+		memcpy(link->buf + 1, buffer, n);
+		if (write(link->fd, link->buf, n + 1) != (ssize_t)(n + 1))
+			return false;
+		buffer += n;
+		size -= n;
+	}
+	return true;
+}
+
+struct bus {
+	struct transport t;
+	uint64_t busy_ns;
+	uint64_t bytes;
+	uint32_t errors;
+};
+
+static bool timed_write(void *conn_info, const uint8_t *buffer, size_t size,
+			bool is_cmd)
+{
+	struct bus *bus = (struct bus *)conn_info;
+	uint64_t start = now_ns();
+	bool ok = bus->t.write(bus->t.conn, buffer, size, is_cmd);
+
+	bus->busy_ns += now_ns() - start;
+	bus->bytes += size;
+	if (!ok)
+		bus->errors++;
+	return ok;
+}
+
+static struct sim_link *sim_link;
+
+static int open_transport(const char *spec, struct transport *t)
+{
+	if (!strncmp(spec, "sim", 3)) {
+		sim_link = calloc(1, sizeof(*sim_link));
+		if (!sim_link)
+			return -1;
+		sim_link->hz = spec[3] == ':' ? (uint32_t)atol(spec + 4) : 400000;
+		t->name = "sim";
+		t->write = sim_link_write;
+		t->conn = sim_link;
+		return 0;
+	}
+	if (!strncmp(spec, "i2c:", 4)) {
+		char path[64];
+		const char *colon = strchr(spec + 4, ':');
+		long addr = colon ? strtol(colon + 1, NULL, 0) : SSD1306_I2C_ADDR1;
+		size_t len = colon ? (size_t)(colon - spec - 4) : strlen(spec + 4);
+		struct i2c_link *link = calloc(1, sizeof(*link));
+
+		if (!link || len >= sizeof(path))
+			return -1;
+		memcpy(path, spec + 4, len);
+		path[len] = '\0';
+		link->fd = open(path, O_RDWR | O_CLOEXEC);
+		if (link->fd < 0 || ioctl(link->fd, I2C_SLAVE, addr) < 0) {
+			perror(path);
+			return -1;
+		}
+		t->name = "i2c";
+		t->write = i2c_link_write;
+		t->conn = link;
+		return 0;
+	}
+	return -1;
+}
+
+
+
+/*
+ * The shared framebuffer.  A memfd is sealed against resizing so a
+ * client can't truncate it under the daemon; shm_open is the fallback.
+ */
+static int create_framebuffer(size_t size)
+{
+	int fd;
+#ifdef MFD_ALLOW_SEALING
+	fd = memfd_create("ssd1306-fb", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd >= 0) {
+		if (ftruncate(fd, (off_t)size) < 0) {
+			close(fd);
+			return -1;
+		}
+		fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+		return fd;
+	}
+#endif
+	char name[32];
+	snprintf(name, sizeof(name), "/ssd1306-fb-%d", (int)getpid());
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0)
+		return -1;
+	shm_unlink(name);
+	if (ftruncate(fd, (off_t)size) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int send_hello(int sock, int fb_fd, const struct fbd_hello *hello)
+{
+	char control[CMSG_SPACE(sizeof(int))];
+	struct iovec iov = { (void *)hello, sizeof(*hello) };
+	struct msghdr msg;
+
+	memset(&msg, 0, sizeof(msg));
+	memset(control, 0, sizeof(control));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &fb_fd, sizeof(int));
+
+	return sendmsg(sock, &msg, MSG_NOSIGNAL) == sizeof(*hello) ? 0 : -1;
+}
+
+
+
+struct client {
+	int fd;
+	pid_t pid;
+	bool pending;
+	uint64_t pending_since;
+	uint32_t pending_seq;
+
+	uint32_t damages;
+	uint32_t flushes;
+	uint64_t latency_sum_us;
+	uint32_t latency_max_us;
+};
+
+static struct {
+	uint8_t *frame;
+	void *ssd1306;
+	struct bus bus;
+	struct ssd1306_damage damage;
+
+	struct client clients[MAX_CLIENTS];
+	int nclients;
+
+	uint64_t started;
+	uint32_t flushes;
+	uint32_t damages;
+} d;
+
+static volatile sig_atomic_t quit, report;
+
+static void on_signal(int sig)
+{
+	if (sig == SIGUSR1)
+		report = 1;
+	else
+		quit = 1;
+}
+
+/*
+ * Sends the merged damage straight out of the shared mapping.  Clients
+ * only hear back once all of it is on the panel; if some of it didn't
+ * make it, it stays dirty and goes again at the next interval.
+ */
+static void flush_damage(void)
+{
+	if (!ssd1306_damage_flush(&d.damage, d.frame, d.ssd1306))
+		return;
+	d.flushes++;
+
+	uint64_t now = now_ns();
+	for (int i = 0; i < d.nclients; i++) {
+		struct client *c = &d.clients[i];
+		if (!c->pending)
+			continue;
+
+		uint32_t us = (uint32_t)((now - c->pending_since) / 1000);
+		struct fbd_done done = { fbd_done, c->pending_seq, us };
+
+		c->pending = false;
+		c->flushes++;
+		c->latency_sum_us += us;
+		if (us > c->latency_max_us)
+			c->latency_max_us = us;
+		/* A client that stopped reading just misses the notice */
+		send(c->fd, &done, sizeof(done), MSG_DONTWAIT | MSG_NOSIGNAL);
+	}
+}
+
+static uint32_t bus_busy_permille(void)
+{
+	uint64_t run = now_ns() - d.started;
+	return run ? (uint32_t)(d.bus.busy_ns * 1000 / run) : 0;
+}
+
+static void fill_stats(const struct client *c, struct fbd_stats *st)
+{
+	memset(st, 0, sizeof(*st));
+	st->type = fbd_stats;
+	st->damages = c->damages;
+	st->flushes = c->flushes;
+	st->latency_avg_us = c->flushes ?
+			     (uint32_t)(c->latency_sum_us / c->flushes) : 0;
+	st->latency_max_us = c->latency_max_us;
+	st->bus_busy_permille = bus_busy_permille();
+	st->bus_bytes = d.bus.bytes;
+}
+
+static void print_client(const struct client *c)
+{
+	struct fbd_stats st;
+
+	fill_stats(c, &st);
+	fprintf(stderr, "  pid %-6d %6u damages %6u flushes, latency avg %u us "
+		"max %u us\n", (int)c->pid, st.damages, st.flushes,
+		st.latency_avg_us, st.latency_max_us);
+}
+
+static void print_report(void)
+{
+	uint32_t busy = bus_busy_permille();
+
+	fprintf(stderr, "%s bus: %llu bytes, %u.%u%% busy, %u errors; "
+		"%u damages in %u flushes\n", d.bus.t.name,
+		(unsigned long long)d.bus.bytes, busy / 10, busy % 10,
+		d.bus.errors, d.damages, d.flushes);
+	for (int i = 0; i < d.nclients; i++)
+		print_client(&d.clients[i]);
+}
+
+static void drop_client(int i)
+{
+	fprintf(stderr, "client gone:\n");
+	print_client(&d.clients[i]);
+	close(d.clients[i].fd);
+	d.clients[i] = d.clients[--d.nclients];
+}
+
+/* Returns false when the client should be dropped */
+static bool handle_client(struct client *c)
+{
+	union fbd_msg msg;
+	ssize_t n = recv(c->fd, &msg, sizeof(msg), MSG_DONTWAIT);
+
+	if (n < 0)
+		return errno == EAGAIN || errno == EINTR;
+	if (n < (ssize_t)sizeof(msg.type))
+		return false;
+
+	switch (msg.type) {
+	case fbd_damage:
+		if (n < (ssize_t)sizeof(msg.damage))
+			return false;
+		c->damages++;
+		d.damages++;
+		if (!ssd1306_damage_add(&d.damage, msg.damage.x, msg.damage.y,
+					msg.damage.width, msg.damage.height) &&
+		    !c->pending) {
+			/* Nothing of it is on the panel, so nothing to wait for */
+			struct fbd_done done = { fbd_done, msg.damage.seq, 0 };
+			send(c->fd, &done, sizeof(done), MSG_DONTWAIT | MSG_NOSIGNAL);
+			return true;
+		}
+		if (!c->pending)
+			c->pending_since = now_ns();
+		c->pending = true;
+		c->pending_seq = msg.damage.seq;
+		return true;
+	case fbd_stats:
+		fill_stats(c, &msg.stats);
+		send(c->fd, &msg.stats, sizeof(msg.stats), MSG_DONTWAIT | MSG_NOSIGNAL);
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void accept_client(int listener, int fb_fd,
+			  const struct fbd_hello *hello)
+{
+	int fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+	if (fd < 0)
+		return;
+	if (d.nclients == MAX_CLIENTS || send_hello(fd, fb_fd, hello)) {
+		close(fd);
+		return;
+	}
+
+	struct client *c = &d.clients[d.nclients++];
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+
+	memset(c, 0, sizeof(*c));
+	c->fd = fd;
+	if (!getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len))
+		c->pid = cred.pid;
+}
+
+/* Only meaningful unrotated, where frame and GDDRAM share a layout */
+static int check_sim(const struct ssd1306_panel *panel)
+{
+	const uint8_t width = d.damage.width;
+
+	for (int p = 0; p < d.damage.pages; p++) {
+		if (memcmp(&sim_link->sim.gddram[p][panel->column_offset],
+			   d.frame + p * width, width)) {
+			fprintf(stderr, "FAIL: GDDRAM page %d differs from the "
+				"framebuffer\n", p);
+			return 1;
+		}
+	}
+	fprintf(stderr, "OK: GDDRAM matches the framebuffer\n");
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: linux_fbd "
+		"[-t sim[:bus_hz] | -t i2c:/dev/i2c-N[:addr]]\n"
+		"\t[-p 128x32|128x64|96x16|64x48|72x40|sh1106|ssd1309]\n"
+		"\t[-o 0|90|180|270] [-i interval_ms] [-s socket] [-x]\n");
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	const char *transport = "sim";
+	const char *path = FBD_SOCKET;
+	enum ssd1306_screen_type type = ssd1306_128_64;
+	enum ssd1306_orientation orient = ssd1306_rotate_0;
+	uint64_t interval_ns = 20 * 1000000u;
+	bool exit_when_idle = false;
+	bool had_client = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "t:p:o:i:s:x")) != -1) {
+		switch (opt) {
+		case 't':
+			transport = optarg;
+			break;
+		case 'p': {
+			size_t i;
+			for (i = 0; i < sizeof(panels) / sizeof(panels[0]); i++)
+				if (!strcmp(optarg, panels[i].name))
+					break;
+			if (i == sizeof(panels) / sizeof(panels[0]))
+				usage();
+			type = panels[i].type;
+			break;
+		}
+		case 'o':
+			switch (atoi(optarg)) {
+			case 0: orient = ssd1306_rotate_0; break;
+			case 90: orient = ssd1306_rotate_90; break;
+			case 180: orient = ssd1306_rotate_180; break;
+			case 270: orient = ssd1306_rotate_270; break;
+			default: usage();
+			}
+			break;
+		case 'i':
+			interval_ns = (uint64_t)atol(optarg) * 1000000u;
+			break;
+		case 's':
+			path = optarg;
+			break;
+		case 'x':
+			exit_when_idle = true;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (open_transport(transport, &d.bus.t)) {
+		fprintf(stderr, "linux_fbd: can't open transport %s\n", transport);
+		return 1;
+	}
+
+	const struct ssd1306_panel *panel = ssd1306_panel_for(type);
+	uint8_t ssd1306_obj[sizeof_ssd1306()];
+	d.ssd1306 = (void *)ssd1306_obj;
+	if (sim_link)
+		ssd1306_sim_init(&sim_link->sim, panel->ram_width, 8, 1);
+	new_ssd1306(d.ssd1306, &d.bus, timed_write);
+	ssd1306_default_init(d.ssd1306, type, ssd1306_switchcap, ssd1306_horiz_a);
+	ssd1306_orientation(d.ssd1306, orient);
+
+	struct fbd_hello hello = { fbd_hello, FBD_VERSION,
+				   ssd1306_frame_width(d.ssd1306),
+				   ssd1306_frame_height(d.ssd1306), 0 };
+	if (!ssd1306_damage_init(&d.damage, (uint8_t)hello.width,
+				 (uint8_t)hello.height)) {
+		fprintf(stderr, "linux_fbd: %ux%u frame is too tall\n",
+			hello.width, hello.height);
+		return 1;
+	}
+	hello.size = (uint32_t)d.damage.width * d.damage.pages;
+
+	int fb_fd = create_framebuffer(hello.size);
+	if (fb_fd < 0) {
+		perror("framebuffer");
+		return 1;
+	}
+	d.frame = mmap(NULL, hello.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		       fb_fd, 0);
+	if (d.frame == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+	ssd1306_flush(d.ssd1306, d.frame);
+
+	int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	unlink(path);
+	if (listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(listener, MAX_CLIENTS)) {
+		perror(path);
+		return 1;
+	}
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGUSR1, &sa, NULL);
+
+	fprintf(stderr, "linux_fbd: %ux%u frame on %s, %s\n", hello.width,
+		hello.height, transport, path);
+
+	d.started = now_ns();
+	uint64_t next_flush = 0;
+
+	while (!quit) {
+		struct pollfd fds[1 + MAX_CLIENTS];
+		int timeout = -1;
+
+		fds[0].fd = listener;
+		fds[0].events = POLLIN;
+		for (int i = 0; i < d.nclients; i++) {
+			fds[1 + i].fd = d.clients[i].fd;
+			fds[1 + i].events = POLLIN;
+		}
+
+		/* Flush pacing: damage waits until the interval is up */
+		if (ssd1306_damage_pending(&d.damage)) {
+			uint64_t now = now_ns();
+			timeout = now >= next_flush ? 0 :
+				  (int)((next_flush - now + 999999) / 1000000);
+		}
+
+		int ready = poll(fds, 1 + d.nclients, timeout);
+		if (ready < 0 && errno != EINTR)
+			break;
+
+		if (report) {
+			report = 0;
+			print_report();
+		}
+
+		if (ready > 0) {
+			/* Back to front, as dropping moves the last client down */
+			for (int i = d.nclients - 1; i >= 0; i--) {
+				if (!(fds[1 + i].revents & (POLLIN | POLLHUP | POLLERR)))
+					continue;
+				if (!handle_client(&d.clients[i]))
+					drop_client(i);
+			}
+			if (fds[0].revents & POLLIN) {
+				accept_client(listener, fb_fd, &hello);
+				had_client = true;
+			}
+		}
+
+		if (ssd1306_damage_pending(&d.damage) && now_ns() >= next_flush) {
+			flush_damage();
+			next_flush = now_ns() + interval_ns;
+		}
+
+		if (exit_when_idle && had_client && !d.nclients &&
+		    !ssd1306_damage_pending(&d.damage))
+			break;
+	}
+
+	if (ssd1306_damage_pending(&d.damage))
+		flush_damage();
+	print_report();
+	unlink(path);
+
+	if (exit_when_idle && sim_link) {
+		if (orient != ssd1306_rotate_0) {
+			fprintf(stderr, "GDDRAM not checked when rotated\n");
+			return 0;
+		}
+		return check_sim(panel);
+	}
+	return 0;
+}
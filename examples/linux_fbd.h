@@ -0,0 +1,76 @@
+#ifndef LINUX_FBD_H
+#define LINUX_FBD_H
+
+#include <stdint.h>
+
+/*
+ * The protocol between linux_fbd (the display daemon) and its clients,
+ * over a SOCK_SEQPACKET Unix socket so every message arrives whole.
+ *
+ * On connect the daemon sends an fbd_hello with the framebuffer's memfd
+ * attached (SCM_RIGHTS).  Clients mmap it shared and draw straight into
+ * it: page-major, width bytes per page, bit 0 at the top, as flush()
+ * takes it.  After drawing they send an fbd_damage for the rectangle
+ * they touched, and the daemon answers with an fbd_done carrying the
+ * same seq once a flush covering it has reached the panel; a flush
+ * that fails is retried, and nothing is acknowledged until it works.
+ * Damage that lies wholly off the frame is acknowledged straight away
+ * with a latency of 0, unless earlier damage is still waiting, in
+ * which case it is acknowledged along with that.  An
+ * fbd_stats request is answered with that client's numbers.
+ */
+
+#define FBD_SOCKET "/tmp/ssd1306-fbd.sock"
+#define FBD_VERSION 1
+
+enum fbd_msg_type {
+	fbd_hello = 1,
+	fbd_damage,
+	fbd_done,
+	fbd_stats
+};
+
+struct fbd_hello {
+	uint32_t type;
+	uint32_t version;
+	uint16_t width;
+	uint16_t height;
+	uint32_t size;		/* bytes to mmap */
+};
+
+/* In pixels; clipped to the panel */
+struct fbd_damage {
+	uint32_t type;
+	uint32_t seq;
+	int16_t x;
+	int16_t y;
+	int16_t width;
+	int16_t height;
+};
+
+struct fbd_done {
+	uint32_t type;
+	uint32_t seq;
+	uint32_t latency_us;	/* damage received to flush finished */
+};
+
+/* Sent empty as a request; the reply is filled in */
+struct fbd_stats {
+	uint32_t type;
+	uint32_t damages;
+	uint32_t flushes;	/* flushes that carried this client's damage */
+	uint32_t latency_avg_us;
+	uint32_t latency_max_us;
+	uint32_t bus_busy_permille;	/* of the daemon's run time */
+	uint64_t bus_bytes;
+};
+
+union fbd_msg {
+	uint32_t type;
+	struct fbd_hello hello;
+	struct fbd_damage damage;
+	struct fbd_done done;
+	struct fbd_stats stats;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ * A linux_fbd client.  Maps the shared framebuffer, animates a pattern
+ * inside its own rectangle, posts the damage for each frame and waits
+ * for the daemon to say it is on the panel.  Prints its latency and the
+ * bus numbers at the end.
+ *
+ *	cc -std=c99 -Ilib examples/linux_fbd_client.c -o linux_fbd_client
+ *
+ * A test run against the simulator, with three clients sharing pages
+ * and one whose rectangle is off the 128x64 frame altogether:
+ *
+ *	./linux_fbd -t sim:1000000 -x &
+ *	./linux_fbd_client -r 0,0,64,20 & ./linux_fbd_client -r 64,0,64,20 &
+ *	./linux_fbd_client -r 0,70,16,8 -n 2 &
+ *	./linux_fbd_client -r 10,20,100,44; wait
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "linux_fbd.h"
+
+static uint8_t *frame;
+static int width, height;
+
+/*
+ * Clients can share a page, and so a byte, so pixels are set with
+ * atomic read-modify-writes rather than plain stores.
+ */
+static void set_pixel(int x, int y, int on)
+{
+	uint8_t *byte = &frame[(y / 8) * width + x];
+	uint8_t bit = (uint8_t)(1 << (y % 8));
+
+	if (on)
+		__atomic_fetch_or(byte, bit, __ATOMIC_RELAXED);
+	else
+		__atomic_fetch_and(byte, (uint8_t)~bit, __ATOMIC_RELAXED);
+}
+
+static int connect_daemon(const char *path)
+{
+	struct sockaddr_un addr;
+	int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+	/* The daemon may still be starting */
+	for (int tries = 0; tries < 50; tries++) {
+		if (!connect(sock, (struct sockaddr *)&addr, sizeof(addr)))
+			return sock;
+		usleep(20000);
+	}
+	perror(path);
+	return -1;
+}
+
+static int receive_hello(int sock, struct fbd_hello *hello)
+{
+	char control[CMSG_SPACE(sizeof(int))];
+	struct iovec iov = { hello, sizeof(*hello) };
+	struct msghdr msg;
+	int fd = -1;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != sizeof(*hello) ||
+	    hello->type != fbd_hello || hello->version != FBD_VERSION)
+		return -1;
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+	    cmsg->cmsg_type == SCM_RIGHTS)
+		memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	return fd;
+}
+
+/* Waits for the fbd_done (or fbd_stats reply) of the given type */
+static int wait_for(int sock, uint32_t type, union fbd_msg *msg)
+{
+	while (recv(sock, msg, sizeof(*msg), 0) > 0)
+		if (msg->type == type)
+			return 0;
+	return -1;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = FBD_SOCKET;
+	int x0 = 0, y0 = 0, w = 32, h = 16;
+	int frames = 100;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:r:n:")) != -1) {
+		switch (opt) {
+		case 's':
+			path = optarg;
+			break;
+		case 'r':
+			if (sscanf(optarg, "%d,%d,%d,%d", &x0, &y0, &w, &h) != 4)
+				return 2;
+			break;
+		case 'n':
+			frames = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: linux_fbd_client [-s socket] "
+				"[-r x,y,w,h] [-n frames]\n");
+			return 2;
+		}
+	}
+
+	int sock = connect_daemon(path);
+	struct fbd_hello hello;
+	int fd = sock < 0 ? -1 : receive_hello(sock, &hello);
+	if (fd < 0) {
+		fprintf(stderr, "linux_fbd_client: no framebuffer from daemon\n");
+		return 1;
+	}
+
+	frame = mmap(NULL, hello.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (frame == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+	width = hello.width;
+	height = hello.height;
+	if (x0 + w > width)
+		w = width - x0;
+	if (y0 + h > height)
+		h = height - y0;
+
+	union fbd_msg msg;
+	for (int n = 0; n < frames; n++) {
+		/* A diagonal stripe pattern that slides one pixel a frame */
+		for (int y = y0; y < y0 + h; y++)
+			for (int x = x0; x < x0 + w; x++)
+				set_pixel(x, y, ((x + y + n) / 4) & 1);
+
+		struct fbd_damage dmg = { fbd_damage, (uint32_t)n,
+					  (int16_t)x0, (int16_t)y0,
+					  (int16_t)w, (int16_t)h };
+		if (send(sock, &dmg, sizeof(dmg), 0) != sizeof(dmg) ||
+		    wait_for(sock, fbd_done, &msg))
+			return 1;
+	}
+
+	struct fbd_stats req = { fbd_stats, 0, 0, 0, 0, 0, 0 };
+	if (send(sock, &req, sizeof(req), 0) != sizeof(req) ||
+	    wait_for(sock, fbd_stats, &msg))
+		return 1;
+
+	printf("client %d,%d %dx%d: %u damages in %u flushes, latency avg %u us "
+	       "max %u us; bus %u.%u%% busy, %llu bytes\n", x0, y0, w, h,
+	       msg.stats.damages, msg.stats.flushes, msg.stats.latency_avg_us,
+	       msg.stats.latency_max_us, msg.stats.bus_busy_permille / 10,
+	       msg.stats.bus_busy_permille % 10,
+	       (unsigned long long)msg.stats.bus_bytes);
+	return 0;
+}
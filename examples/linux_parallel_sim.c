@@ -0,0 +1,250 @@
+/*
+ * A GPIO backend for the parallel transport that runs on Linux (or any
+ * host) against the simulated controller.  It keeps a virtual clock,
+ * checks every edge against the datasheet timing, and latches bytes
+ * into the simulator so byte order can be verified without hardware.
+ *
+ *	c++ -std=c++11 -c lib/ssd1306.cpp lib/ssd1306_c.cpp lib/ssd1306_panel.cpp \
+ *		lib/ssd1306_parallel.cpp
+ *	cc -std=c99 -Ilib examples/linux_parallel_sim.c examples/ssd1306_sim.c \
+ *		ssd1306.o ssd1306_c.o ssd1306_panel.o ssd1306_parallel.o \
+ *		-o linux_parallel_sim
+ *	./linux_parallel_sim
+ */
+#include <stdio.h>
+#include <string.h>
+#include "ssd1306_sim.h"
+#include "ssd1306.h"
+#include "ssd1306_parallel.h"
+
+typedef struct gpio_sim {
+	ssd1306_sim *sim;
+	enum ssd1306_bus bus;
+	const struct ssd1306_parallel_timing *timing;
+	/* Time each GPIO call takes, on top of explicit delays */
+	uint32_t op_ns;
+
+	uint64_t now;
+	bool level[4];
+	bool output;
+	uint8_t data;
+	uint8_t read_value;
+
+	uint64_t data_at;
+	uint64_t dc_at;
+	uint64_t active_at;
+	uint64_t latched_at;
+	bool latched;
+
+	unsigned long violations;
+} gpio_sim;
+
+static void violation(gpio_sim *g, const char *what, uint64_t got, uint32_t need)
+{
+	if (!g->violations++)
+		printf("  timing violation at %llu ns: %s %llu ns < %u ns\n",
+		       (unsigned long long)g->now, what,
+		       (unsigned long long)got, need);
+}
+
+static void check(gpio_sim *g, const char *what, uint64_t since, uint32_t need)
+{
+	if (g->now - since < need)
+		violation(g, what, g->now - since, need);
+}
+
+static bool strobe_pin(gpio_sim *g, enum ssd1306_pin pin)
+{
+	/* 8080 strobes on WR# or RD#, 6800 only on E (the RD pin) */
+	if (g->bus == ssd1306_bus_8080)
+		return pin == ssd1306_pin_wr || pin == ssd1306_pin_rd;
+	return pin == ssd1306_pin_rd;
+}
+
+static bool is_read(gpio_sim *g, enum ssd1306_pin pin)
+{
+	if (g->bus == ssd1306_bus_8080)
+		return pin == ssd1306_pin_rd;
+	return g->level[ssd1306_pin_wr];
+}
+
+static bool strobe_active(gpio_sim *g)
+{
+	if (g->bus == ssd1306_bus_8080)
+		return !g->level[ssd1306_pin_wr] || !g->level[ssd1306_pin_rd];
+	return g->level[ssd1306_pin_rd];
+}
+
+static void sim_port_write(void *port, uint8_t value)
+{
+	gpio_sim *g = (gpio_sim *)port;
+
+	g->now += g->op_ns;
+	if (!g->level[ssd1306_pin_cs]) {
+		if (strobe_active(g))
+			violation(g, "data changed while strobe active", 0, 1);
+		if (g->latched)
+			check(g, "data hold", g->latched_at, g->timing->data_hold);
+	}
+	g->data = value;
+	g->data_at = g->now;
+}
+
+static uint8_t sim_port_read(void *port)
+{
+	gpio_sim *g = (gpio_sim *)port;
+
+	g->now += g->op_ns;
+	if (g->output)
+		violation(g, "read with port driven", 0, 1);
+	check(g, "read access", g->active_at, g->timing->access);
+	return g->read_value;
+}
+
+static void sim_port_dir(void *port, bool output)
+{
+	gpio_sim *g = (gpio_sim *)port;
+
+	g->now += g->op_ns;
+	g->output = output;
+}
+
+static void sim_delay_ns(void *port, uint16_t ns)
+{
+	((gpio_sim *)port)->now += ns;
+}
+
+static void strobe_edge(gpio_sim *g, enum ssd1306_pin pin, bool activating)
+{
+	const struct ssd1306_parallel_timing *t = g->timing;
+	bool read = is_read(g, pin);
+
+	if (activating) {
+		check(g, "address setup", g->dc_at, t->addr_setup);
+		if (g->latched)
+			check(g, "cycle", g->active_at, t->cycle);
+		g->active_at = g->now;
+		if (read)
+			ssd1306_sim_read(g->sim, &g->read_value, 1);
+		return;
+	}
+
+	if (read) {
+		check(g, "read pulse", g->active_at, t->read_active);
+	} else {
+		check(g, "write pulse", g->active_at, t->strobe_active);
+		check(g, "data setup", g->data_at, t->data_setup);
+		ssd1306_sim_write(g->sim, &g->data, 1, !g->level[ssd1306_pin_dc]);
+	}
+	g->latched_at = g->now;
+	g->latched = true;
+}
+
+static void sim_pin(void *port, enum ssd1306_pin pin, bool level)
+{
+	gpio_sim *g = (gpio_sim *)port;
+	bool was = g->level[pin];
+
+	g->now += g->op_ns;
+	g->level[pin] = level;
+	if (was == level)
+		return;
+
+	if (pin == ssd1306_pin_dc) {
+		if (strobe_active(g))
+			violation(g, "D/C changed while strobe active", 0, 1);
+		g->dc_at = g->now;
+	} else if (pin == ssd1306_pin_wr && g->bus == ssd1306_bus_6800) {
+		/* R/W# is an address line on 6800 */
+		g->dc_at = g->now;
+	} else if (strobe_pin(g, pin) && !g->level[ssd1306_pin_cs]) {
+		/* 8080 strobes are active low, E is active high */
+		bool activating = g->bus == ssd1306_bus_8080 ? !level : level;
+		strobe_edge(g, pin, activating);
+	}
+}
+
+static const struct ssd1306_gpio_ops sim_ops = {
+	sim_port_write,
+	sim_port_read,
+	sim_port_dir,
+	sim_pin,
+	sim_delay_ns,
+	NULL
+};
+
+static int run(enum ssd1306_bus bus_type, const char *name)
+{
+	static ssd1306_sim sim;
+	static uint8_t frame[8][128];
+	uint8_t row[128];
+	uint8_t ssd1306_obj[sizeof_ssd1306()];
+	void *ssd1306_ptr = (void *)ssd1306_obj;
+	gpio_sim g;
+	struct ssd1306_parallel bus;
+
+	memset(&g, 0, sizeof(g));
+	g.sim = &sim;
+	g.bus = bus_type;
+	g.timing = bus_type == ssd1306_bus_8080 ? &ssd1306_8080_timing
+						: &ssd1306_6800_timing;
+	g.output = true;
+
+	bus.bus = bus_type;
+	bus.ops = &sim_ops;
+	bus.port = &g;
+	bus.timing = g.timing;
+
+	ssd1306_sim_init(&sim, 128, 8, 1);
+	ssd1306_parallel_init(&bus);
+	new_ssd1306(ssd1306_ptr, &bus, ssd1306_parallel_write);
+	ssd1306_set_read(ssd1306_ptr, ssd1306_parallel_read, 1);
+	ssd1306_default_init(ssd1306_ptr, ssd1306_128_64, ssd1306_switchcap,
+			     ssd1306_horiz_a);
+
+	for (int p = 0; p < 8; p++)
+		for (int x = 0; x < 128; x++)
+			frame[p][x] = (uint8_t)(p * 128 + x * 7);
+
+	ssd1306_column_addr(ssd1306_ptr, 0, 127);
+	ssd1306_page_addr(ssd1306_ptr, 0, 7);
+	uint64_t start = g.now;
+	ssd1306_draw(ssd1306_ptr, &frame[0][0], sizeof(frame));
+	uint64_t frame_ns = g.now - start;
+
+	for (int p = 0; p < 8; p++) {
+		if (memcmp(sim.gddram[p], frame[p], sizeof(frame[p]))) {
+			printf("%s: FAIL: page %d of GDDRAM does not match\n",
+			       name, p);
+			return 1;
+		}
+	}
+
+	ssd1306_column_addr(ssd1306_ptr, 0, 127);
+	ssd1306_page_addr(ssd1306_ptr, 5, 5);
+	ssd1306_read(ssd1306_ptr, row, sizeof(row));
+	if (memcmp(row, frame[5], sizeof(row))) {
+		printf("%s: FAIL: readback does not match\n", name);
+		return 1;
+	}
+
+	if (g.violations) {
+		printf("%s: FAIL: %lu timing violations\n", name, g.violations);
+		return 1;
+	}
+
+	/* I2C at 400 kHz: 9 clocks per byte plus address and control bytes */
+	printf("%s: OK: frame %llu ns (model %lu ns), I2C 400 kHz ~%lu ns\n",
+	       name, (unsigned long long)frame_ns,
+	       (unsigned long)ssd1306_parallel_burst_ns(&bus, sizeof(frame)),
+	       (unsigned long)((sizeof(frame) + 2) * 9 * 2500UL));
+	return 0;
+}
+
+int main(void)
+{
+	int failed = 0;
+	failed |= run(ssd1306_bus_8080, "8080");
+	failed |= run(ssd1306_bus_6800, "6800");
+	return failed;
+}
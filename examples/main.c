@@ -59,7 +59,7 @@ int main(void)
 	/* fill buffer with lines */
 	memset(buf, 0xAA, sizeof(buf));
 
-	ssd1306_default_init(ssd1306_ptr, type, ssd1306_switchcap);
+	ssd1306_default_init(ssd1306_ptr, type, ssd1306_switchcap, ssd1306_horiz_a);
 
 	ssd1306_draw(ssd1306_ptr, buf, sizeof(buf));
 
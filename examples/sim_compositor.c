@@ -0,0 +1,198 @@
+/*
+ * Moves a few sprites over a background with the compositor and checks
+ * the simulated panel against a frame built pixel by pixel after every
+ * flush, unrotated and with the panel turned 90 degrees (a 64x128
+ * frame).  Prints how many data bytes went over the bus compared with
+ * sending whole frames.
+ *
+ *	c++ -std=c++11 -c lib/ssd1306.cpp lib/ssd1306_c.cpp lib/ssd1306_panel.cpp \
+ *		lib/ssd1306_compositor.cpp
+ *	cc -std=c99 -Ilib examples/sim_compositor.c examples/ssd1306_sim.c \
+ *		ssd1306.o ssd1306_c.o ssd1306_panel.o ssd1306_compositor.o \
+ *		-o sim_compositor
+ *	./sim_compositor [horiz|page]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306_sim.h"
+#include "ssd1306.h"
+#include "ssd1306_compositor.h"
+
+#define FRAME_SIZE (128 * 64 / 8)
+#define FRAMES 300
+
+/* The frame, which is 64x128 when turned */
+static int width, height;
+
+static uint8_t background[FRAME_SIZE];
+static uint8_t ball[12 * 2];
+static uint8_t ball_mask[12 * 2];
+static uint8_t cursor[7 * 2];
+static uint8_t bar[128 * 1];
+
+static int get_pixel(const uint8_t *data, int width, int x, int y)
+{
+	return (data[(y / 8) * width + x] >> (y % 8)) & 1;
+}
+
+/* What the frame should be, one pixel at a time */
+static void reference(const struct ssd1306_layer *layers, int count,
+		      uint8_t *out)
+{
+	memset(out, 0, FRAME_SIZE);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			int v = 0;
+			for (int i = 0; i < count; i++) {
+				const struct ssd1306_layer *l = &layers[i];
+				int lx = x - l->x, ly = y - l->y;
+				if (!l->visible || lx < 0 || ly < 0 ||
+				    lx >= l->width || ly >= l->height)
+					continue;
+				if (l->mask && !get_pixel(l->mask, l->width, lx, ly))
+					continue;
+				int s = get_pixel(l->pixels, l->width, lx, ly);
+				switch (l->blend) {
+				case ssd1306_blend_copy: v = s; break;
+				case ssd1306_blend_or: v |= s; break;
+				case ssd1306_blend_and: v &= s; break;
+				case ssd1306_blend_xor: v ^= s; break;
+				}
+			}
+			if (v)
+				out[(y / 8) * width + x] |= 1 << (y % 8);
+		}
+	}
+}
+
+/* GDDRAM holds the frame as is, or transposed when turned */
+static int matches(const ssd1306_sim *sim, const uint8_t *frame, bool turned)
+{
+	for (int y = 0; y < 64; y++) {
+		for (int x = 0; x < 128; x++) {
+			int ram = (sim->gddram[y / 8][x] >> (y % 8)) & 1;
+			int want = turned ? get_pixel(frame, width, y, x)
+					  : get_pixel(frame, width, x, y);
+			if (ram != want)
+				return 0;
+		}
+	}
+	return 1;
+}
+
+static void make_sprites(void)
+{
+	for (int i = 0; i < (int)sizeof(background); i++)
+		background[i] = (i & 1) ? 0xAA : 0x55;
+
+	/* A 12x12 disc with a hollow centre, masked to the disc */
+	for (int y = 0; y < 12; y++) {
+		for (int x = 0; x < 12; x++) {
+			int dx = 2 * x - 11, dy = 2 * y - 11;
+			int r2 = dx * dx + dy * dy;
+			if (r2 <= 121)
+				ball_mask[(y / 8) * 12 + x] |= 1 << (y % 8);
+			if (r2 <= 121 && r2 > 25)
+				ball[(y / 8) * 12 + x] |= 1 << (y % 8);
+		}
+	}
+
+	for (int x = 0; x < 7; x++)
+		cursor[x] = cursor[7 + x] = (uint8_t)(0xFF >> x);
+	for (size_t x = 0; x < sizeof(bar); x++)
+		bar[x] = (x % 4) ? 0x7E : 0x00;
+}
+
+static int run(enum ssd1306_addr_mode mode, enum ssd1306_orientation o)
+{
+	static ssd1306_sim sim;
+	static uint8_t frame[FRAME_SIZE];
+	static uint8_t expected[FRAME_SIZE];
+	uint8_t ssd1306_obj[sizeof_ssd1306()];
+	void *ssd1306_ptr = (void *)ssd1306_obj;
+	struct ssd1306_compositor comp;
+	const bool turned = o == ssd1306_rotate_90;
+
+	ssd1306_sim_init(&sim, 128, 8, 1);
+	new_ssd1306(ssd1306_ptr, &sim, ssd1306_sim_write);
+	ssd1306_default_init(ssd1306_ptr, ssd1306_128_64, ssd1306_switchcap, mode);
+	ssd1306_orientation(ssd1306_ptr, o);
+	width = ssd1306_frame_width(ssd1306_ptr);
+	height = ssd1306_frame_height(ssd1306_ptr);
+
+	struct ssd1306_layer layers[] = {
+		{ background, NULL, (uint8_t)width, (uint8_t)height, 0, 0,
+		  ssd1306_blend_copy, true },
+		{ ball, ball_mask, 12, 12, 10, 5, ssd1306_blend_copy, true },
+		{ ball, NULL, 12, 12, 30, 30, ssd1306_blend_xor, true },
+		{ cursor, NULL, 7, 11, 0, 0, ssd1306_blend_or, true },
+		{ bar, NULL, (uint8_t)width, 8, 0, (int16_t)(height - 8),
+		  ssd1306_blend_and, true },
+	};
+	const int count = sizeof(layers) / sizeof(layers[0]);
+
+	if (!ssd1306_compositor_init(&comp, frame, (uint8_t)width,
+				     (uint8_t)height, layers, count)) {
+		printf("FAIL: %dx%d frame refused\n", width, height);
+		return 1;
+	}
+
+	srand(1);
+	unsigned long start = sim.data_bytes;
+	int vx = 3, vy = 2;
+
+	for (int n = 0; n < FRAMES; n++) {
+		struct ssd1306_layer *b = &layers[1];
+		int x = b->x + vx, y = b->y + vy;
+		if (x < -6 || x > width - 6)
+			vx = -vx;
+		if (y < -6 || y > height - 6)
+			vy = -vy;
+		ssd1306_layer_move(&comp, b, (int16_t)x, (int16_t)y);
+
+		if (n % 7 == 0)
+			ssd1306_layer_move(&comp, &layers[2],
+					   (int16_t)(rand() % (width + 12) - 12),
+					   (int16_t)(rand() % (height + 12) - 12));
+		ssd1306_layer_move(&comp, &layers[3], (int16_t)(rand() % width),
+				   (int16_t)(rand() % height));
+		if (n % 50 == 25)
+			ssd1306_layer_show(&comp, &layers[4], !layers[4].visible);
+		if (n % 40 == 0) {
+			layers[1].blend = (enum ssd1306_blend)((n / 40) % 4);
+			ssd1306_layer_changed(&comp, &layers[1]);
+		}
+
+		if (!ssd1306_compositor_flush(&comp, ssd1306_ptr)) {
+			printf("FAIL: flush %d reported an error\n", n);
+			return 1;
+		}
+
+		reference(layers, count, expected);
+		if (memcmp(frame, expected, sizeof(frame)) ||
+		    !matches(&sim, expected, turned)) {
+			printf("FAIL: %dx%d frame %d differs from the reference\n",
+			       width, height, n);
+			return 1;
+		}
+	}
+
+	unsigned long sent = sim.data_bytes - start;
+	printf("OK: %dx%d, %d frames, %lu data bytes sent, %lu for full frames "
+	       "(%lu%%)\n", width, height, FRAMES, sent,
+	       (unsigned long)FRAMES * sizeof(frame),
+	       sent * 100 / ((unsigned long)FRAMES * sizeof(frame)));
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	enum ssd1306_addr_mode mode = ssd1306_horiz_a;
+
+	if (argc > 1 && !strcmp(argv[1], "page"))
+		mode = ssd1306_page_a;
+
+	make_sprites();
+	return run(mode, ssd1306_rotate_0) || run(mode, ssd1306_rotate_90);
+}
@@ -0,0 +1,232 @@
+/*
+ * Drives the fault-tolerant flush path through a transport that fails
+ * transfers part way through.  After every flush or region flush it
+ * checks that the region reached the panel, that repair() kept to the
+ * retry limit and only resent pages of that region, and that no other
+ * page was touched.  Then it corrupts GDDRAM behind the driver's back
+ * and lets refresh_step() find it, and checks that draw_bitmap() stops
+ * at the first failed transfer.  With 1 every transfer fails, so the
+ * run stops at the first region that can't be repaired.
+ *
+ *	c++ -std=c++11 -c lib/ssd1306.cpp lib/ssd1306_c.cpp lib/ssd1306_panel.cpp
+ *	cc -std=c99 -Ilib examples/sim_faults.c examples/ssd1306_sim.c \
+ *		ssd1306.o ssd1306_c.o ssd1306_panel.o -o sim_faults
+ *	./sim_faults [fail one transfer in N]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306_sim.h"
+#include "ssd1306.h"
+#include "ssd1306_asset.h"
+
+#define RETRIES 4
+#define MAX_REPAIRS 100
+
+typedef struct faulty_link {
+	ssd1306_sim *sim;
+	unsigned fail_one_in;
+	unsigned long injected;
+	unsigned long slept_ms;
+	unsigned long since_fault;	/* transfers since the last fault */
+} faulty_link;
+
+/*
+ * Fails one transfer in fail_one_in after letting a random part of it
+ * through, like a NACK half way into a frame.
+ */
+static bool faulty_write(void *conn_info, const uint8_t *buffer, size_t size,
+			 bool is_cmd)
+{
+	faulty_link *link = (faulty_link *)conn_info;
+
+	if (link->fail_one_in && rand() % link->fail_one_in == 0) {
+		link->injected++;
+		link->since_fault = 0;
+		ssd1306_sim_write(link->sim, buffer, rand() % (size + 1), is_cmd);
+		/* The STOP ends the transfer, so drop any half-sent command */
+		link->sim->cmd_len = 0;
+		return false;
+	}
+	link->since_fault++;
+	return ssd1306_sim_write(link->sim, buffer, size, is_cmd);
+}
+
+static void fake_delay(void *conn_info, uint16_t ms)
+{
+	((faulty_link *)conn_info)->slept_ms += ms;
+}
+
+static int matches(const ssd1306_sim *sim, const uint8_t *frame)
+{
+	for (int p = 0; p < 8; p++)
+		if (memcmp(sim->gddram[p], frame + p * 128, 128))
+			return 0;
+	return 1;
+}
+
+static int region_matches(const ssd1306_sim *sim, const uint8_t *frame,
+			  int first, int last, int col, int end)
+{
+	for (int p = first; p <= last; p++)
+		if (memcmp(&sim->gddram[p][col], frame + p * 128 + col,
+			   end - col + 1))
+			return 0;
+	return 1;
+}
+
+/*
+ * Flushes the region (or everything), then checks it on its own: the
+ * retry limit, which pages were resent, and what reached GDDRAM.
+ */
+static int check_flush(ssd1306_sim *sim, void *ssd1306_ptr,
+		       const uint8_t *frame, bool full, unsigned long *gave_up)
+{
+	static uint8_t before[8][132];
+	const struct ssd1306_stats *st = ssd1306_stats(ssd1306_ptr);
+	const struct ssd1306_stats was = *st;
+	int first = 0, last = 7, col = 0, end = 127;
+
+	if (!full) {
+		first = rand() % 8;
+		last = first + rand() % (8 - first);
+		col = rand() % 128;
+		end = col + rand() % (128 - col);
+	}
+
+	memcpy(before, sim->gddram, sizeof(before));
+	bool ok = full ? ssd1306_flush(ssd1306_ptr, frame) :
+		  ssd1306_flush_region(ssd1306_ptr, frame, (uint8_t)first,
+				       (uint8_t)last, (uint8_t)col, (uint8_t)end);
+
+	uint32_t passes = st->retries - was.retries;
+	if (passes > RETRIES || (!ok && passes != RETRIES)) {
+		printf("FAIL: %u repair passes with a limit of %d\n",
+		       (unsigned)passes, RETRIES);
+		return 1;
+	}
+	if (!ok)
+		(*gave_up)++;
+
+	/* If the retries ran out, a few more repairs finish the job */
+	for (int n = 0; ssd1306_unconfirmed_pages(ssd1306_ptr); n++) {
+		if (n == MAX_REPAIRS) {
+			printf("FAIL: pages still unconfirmed after %d repairs\n",
+			       MAX_REPAIRS);
+			return 1;
+		}
+		ssd1306_repair(ssd1306_ptr, frame);
+	}
+
+	passes = st->retries - was.retries;
+	if (st->resent_pages - was.resent_pages > passes * (last - first + 1)) {
+		printf("FAIL: %u pages resent for pages %d-%d in %u passes\n",
+		       (unsigned)(st->resent_pages - was.resent_pages),
+		       first, last, (unsigned)passes);
+		return 1;
+	}
+	for (int p = 0; p < 8; p++) {
+		if ((p < first || p > last) &&
+		    memcmp(before[p], sim->gddram[p], sizeof(before[p]))) {
+			printf("FAIL: page %d outside pages %d-%d was written\n",
+			       p, first, last);
+			return 1;
+		}
+	}
+	if (!region_matches(sim, frame, first, last, col, end)) {
+		printf("FAIL: pages %d-%d, columns %d-%d differ after recovery\n",
+		       first, last, col, end);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * An RLE bitmap of a full frame goes out in many small chunks; after a
+ * failed one nothing more may be sent.
+ */
+static int check_bitmap(faulty_link *link, void *ssd1306_ptr)
+{
+	static const uint8_t data[] = {
+		0xFE, 0x01, 0xFE, 0x02, 0xFE, 0x04, 0xFE, 0x08,
+		0xFE, 0x10, 0xFE, 0x20, 0xFE, 0x40, 0xFE, 0x80
+	};
+	const struct ssd1306_bitmap bmp = { 128, 64, 8, true, sizeof(data), data };
+	unsigned long failed = 0;
+
+	link->fail_one_in = 32;
+	for (int n = 0; n < 50; n++) {
+		unsigned long injected = link->injected;
+		bool ok = ssd1306_draw_bitmap(ssd1306_ptr, &bmp);
+
+		if (ok != (link->injected == injected) ||
+		    (!ok && link->since_fault)) {
+			printf("FAIL: draw_bitmap() returned %d after %lu faults, "
+			       "%lu transfers after the last\n", ok,
+			       link->injected - injected, link->since_fault);
+			return 1;
+		}
+		failed += !ok;
+	}
+	link->fail_one_in = 0;
+	printf("OK: draw_bitmap() stopped at the fault %lu times in 50\n",
+	       failed);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	static ssd1306_sim sim;
+	static uint8_t frame[1024];
+	uint8_t ssd1306_obj[sizeof_ssd1306()];
+	void *ssd1306_ptr = (void *)ssd1306_obj;
+	faulty_link link = { &sim, 0, 0, 0, 0 };
+	unsigned long gave_up = 0;
+
+	ssd1306_sim_init(&sim, 128, 8, 1);
+	new_ssd1306(ssd1306_ptr, &link, faulty_write);
+	ssd1306_default_init(ssd1306_ptr, ssd1306_128_64, ssd1306_switchcap,
+			     ssd1306_horiz_a);
+	ssd1306_set_recovery(ssd1306_ptr, fake_delay, RETRIES, 1);
+
+	srand(1);
+	link.fail_one_in = argc > 1 ? (unsigned)atoi(argv[1]) : 4;
+
+	for (int n = 0; n < 500; n++) {
+		for (int i = 0; i < 64; i++)
+			frame[rand() % sizeof(frame)] = (uint8_t)rand();
+
+		if (check_flush(&sim, ssd1306_ptr, frame, rand() & 1, &gave_up)) {
+			printf("FAIL: frame %d\n", n);
+			return 1;
+		}
+	}
+
+	/* Regions leave the rest of the frame pending, so send it all */
+	link.fail_one_in = 0;
+	if (!ssd1306_flush(ssd1306_ptr, frame) || !matches(&sim, frame)) {
+		printf("FAIL: full flush after the faults\n");
+		return 1;
+	}
+
+	/* Silent corruption the transport never reported */
+	for (int i = 0; i < 16; i++)
+		sim.gddram[rand() % 8][rand() % 128] ^= 0x5A;
+	for (int i = 0; i < 8; i++)
+		ssd1306_refresh_step(ssd1306_ptr, frame);
+	if (!matches(&sim, frame)) {
+		printf("FAIL: background refresh did not repair GDDRAM\n");
+		return 1;
+	}
+	if (check_bitmap(&link, ssd1306_ptr))
+		return 1;
+
+	const struct ssd1306_stats *st = ssd1306_stats(ssd1306_ptr);
+	printf("OK: %lu faults injected, %lu errors, %lu retries, "
+	       "%lu pages resent, %lu refreshes, %lu flushes gave up, "
+	       "%lu ms backing off\n",
+	       link.injected, (unsigned long)st->errors,
+	       (unsigned long)st->retries, (unsigned long)st->resent_pages,
+	       (unsigned long)st->refreshes, gave_up, link.slept_ms);
+	return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Exercises GDDRAM readback and read-modify-write drawing against the
+ * simulated controller, without a host framebuffer on the driver side.
+ *
+ *	c++ -std=c++11 -c lib/ssd1306.cpp lib/ssd1306_c.cpp lib/ssd1306_panel.cpp
+ *	cc -std=c99 -Ilib examples/sim_rmw.c examples/ssd1306_sim.c \
+ *		ssd1306.o ssd1306_c.o ssd1306_panel.o -o sim_rmw
+ *	./sim_rmw [read latency]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306_sim.h"
+#include "ssd1306.h"
+
+static const uint8_t width = 128;
+static const uint8_t pages = 8;
+
+/* A read hook whose bus can't read, e.g. missing GPIO ops */
+static bool broken_read(void *conn_info, uint8_t *buffer, size_t size)
+{
+	(void)conn_info; (void)buffer; (void)size;
+	return false;
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t latency = argc > 1 ? (uint8_t)atoi(argv[1]) : 1;
+	static ssd1306_sim sim;
+	/* The reference copy is only for checking, the driver never sees it */
+	static uint8_t expect[8][128];
+	uint8_t ssd1306_obj[sizeof_ssd1306()];
+	void *ssd1306_ptr = (void *)ssd1306_obj;
+	uint8_t row[128];
+
+	if (latency > SSD1306_SIM_MAX_LATENCY) {
+		fprintf(stderr, "latency must be at most %d\n",
+			SSD1306_SIM_MAX_LATENCY);
+		return 2;
+	}
+
+	ssd1306_sim_init(&sim, width, pages, latency);
+	new_ssd1306(ssd1306_ptr, &sim, ssd1306_sim_write);
+	ssd1306_default_init(ssd1306_ptr, ssd1306_128_64, ssd1306_switchcap,
+			     ssd1306_horiz_a);
+	ssd1306_set_read(ssd1306_ptr, ssd1306_sim_read, latency);
+
+	srand(1);
+	for (uint8_t p = 0; p < pages; p++)
+		for (uint8_t x = 0; x < width; x++)
+			expect[p][x] = (uint8_t)rand();
+	ssd1306_column_addr(ssd1306_ptr, 0, width - 1);
+	ssd1306_page_addr(ssd1306_ptr, 0, pages - 1);
+	ssd1306_draw(ssd1306_ptr, &expect[0][0], sizeof(expect));
+
+	/* Plain readback of one page, split across two reads */
+	ssd1306_column_addr(ssd1306_ptr, 0, width - 1);
+	ssd1306_page_addr(ssd1306_ptr, 3, 3);
+	ssd1306_read(ssd1306_ptr, row, 40);
+	ssd1306_read(ssd1306_ptr, row + 40, width - 40);
+	if (memcmp(row, expect[3], width)) {
+		printf("FAIL: readback of page 3\n");
+		return 1;
+	}
+
+	for (int i = 0; i < 2000; i++) {
+		if (rand() & 1) {
+			uint8_t x = rand() % width;
+			uint8_t y = rand() % (pages * 8);
+			bool on = rand() & 1;
+			uint8_t bit = 1 << (y % 8);
+
+			ssd1306_draw_pixel(ssd1306_ptr, x, y, on);
+			expect[y / 8][x] = on ? expect[y / 8][x] | bit
+					      : expect[y / 8][x] & ~bit;
+		} else {
+			uint8_t page = rand() % pages;
+			uint8_t start = rand() % width;
+			uint8_t end = start + rand() % (width - start);
+			uint8_t and_mask = (uint8_t)rand();
+			uint8_t xor_mask = (uint8_t)rand();
+
+			ssd1306_modify(ssd1306_ptr, page, start, end,
+				       and_mask, xor_mask);
+			for (int x = start; x <= end; x++)
+				expect[page][x] = (expect[page][x] & and_mask) ^ xor_mask;
+		}
+	}
+
+	/* Bad arguments and a failing read must be refused, not run */
+	if (ssd1306_modify(ssd1306_ptr, 0, 10, 5, 0, 0xFF) ||
+	    ssd1306_modify(ssd1306_ptr, pages, 0, 5, 0, 0xFF) ||
+	    ssd1306_modify(ssd1306_ptr, 0, 0, width, 0, 0xFF)) {
+		printf("FAIL: modify() accepted a bad range\n");
+		return 1;
+	}
+	ssd1306_set_read(ssd1306_ptr, broken_read, latency);
+	if (ssd1306_read(ssd1306_ptr, row, 1) ||
+	    ssd1306_modify(ssd1306_ptr, 0, 0, 5, 0, 0xFF)) {
+		printf("FAIL: a failed read was reported as done\n");
+		return 1;
+	}
+
+	for (uint8_t p = 0; p < pages; p++) {
+		if (memcmp(sim.gddram[p], expect[p], width)) {
+			printf("FAIL: page %d differs after read-modify-write\n", p);
+			return 1;
+		}
+	}
+
+	printf("OK: latency %d, %lu bytes read, %lu written, %lu transactions\n",
+	       latency, sim.read_bytes, sim.data_bytes + sim.cmd_bytes,
+	       sim.transactions);
+	return 0;
+}
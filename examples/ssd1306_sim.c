@@ -0,0 +1,163 @@
+#include <string.h>
+#include "ssd1306_sim.h"
+
+/* What a stale latch reads back as, so misuse shows up in tests */
+#define SIM_STALE 0xA5
+
+void ssd1306_sim_init(ssd1306_sim *sim, uint8_t ram_width, uint8_t pages,
+		      uint8_t read_latency)
+{
+	memset(sim, 0, sizeof(*sim));
+	sim->ram_width = ram_width;
+	sim->pages = pages;
+	sim->read_latency = read_latency;
+	/* Reset state from the datasheet: page addressing, full window */
+	sim->mode = 2;
+	sim->col_end = ram_width - 1;
+	sim->page_end = pages - 1;
+	sim->contrast = 0x7F;
+	memset(sim->latch, SIM_STALE, sizeof(sim->latch));
+}
+
+static uint8_t args_for(uint8_t cmd)
+{
+	switch (cmd) {
+	case 0x21: case 0x22: case 0xA3:
+		return 2;
+	case 0x26: case 0x27:
+		return 6;
+	case 0x29: case 0x2A:
+		return 5;
+	case 0x20: case 0x23: case 0x81: case 0x8D: case 0xA8: case 0xAD:
+	case 0xD3:
+	case 0xD5: case 0xD6: case 0xD9: case 0xDA: case 0xDB:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static void run_command(ssd1306_sim *sim)
+{
+	uint8_t *c = sim->cmd;
+
+	if (c[0] <= 0x0F) {
+		sim->page_mode_col = (sim->page_mode_col & 0xF0) | c[0];
+		sim->col = sim->page_mode_col;
+	} else if (c[0] <= 0x1F) {
+		sim->page_mode_col = (sim->page_mode_col & 0x0F) | (c[0] & 0x0F) << 4;
+		sim->col = sim->page_mode_col;
+	} else if (c[0] >= 0xB0 && c[0] <= 0xB7) {
+		sim->page = c[0] & 0x07;
+	} else {
+		switch (c[0]) {
+		case 0x20:
+			sim->mode = c[1] & 0x03;
+			break;
+		case 0x21:
+			sim->col = sim->col_start = c[1];
+			sim->col_end = c[2];
+			break;
+		case 0x22:
+			sim->page = sim->page_start = c[1] & 0x07;
+			sim->page_end = c[2] & 0x07;
+			break;
+		case 0x81:
+			sim->contrast = c[1];
+			break;
+		case 0xA0: case 0xA1:
+			sim->segment_remap = c[0] & 0x01;
+			break;
+		case 0xA6: case 0xA7:
+			sim->inverted = c[0] & 0x01;
+			break;
+		case 0xAE: case 0xAF:
+			sim->display_on = c[0] & 0x01;
+			break;
+		case 0xC0: case 0xC8:
+			sim->com_scan_dec = c[0] & 0x08;
+			break;
+		}
+	}
+}
+
+static void advance(ssd1306_sim *sim)
+{
+	switch (sim->mode) {
+	case 0:
+		if (sim->col++ >= sim->col_end) {
+			sim->col = sim->col_start;
+			if (sim->page++ >= sim->page_end)
+				sim->page = sim->page_start;
+		}
+		break;
+	case 1:
+		if (sim->page++ >= sim->page_end) {
+			sim->page = sim->page_start;
+			if (sim->col++ >= sim->col_end)
+				sim->col = sim->col_start;
+		}
+		break;
+	default:
+		if (++sim->col >= sim->ram_width)
+			sim->col = 0;
+		break;
+	}
+}
+
+static uint8_t *cursor(ssd1306_sim *sim)
+{
+	static uint8_t nowhere;
+
+	if (sim->page >= sim->pages || sim->col >= sim->ram_width)
+		return &nowhere;
+	return &sim->gddram[sim->page][sim->col];
+}
+
+bool ssd1306_sim_write(void *conn_info, const uint8_t *buffer, size_t size,
+		       bool is_cmd)
+{
+	ssd1306_sim *sim = (ssd1306_sim *)conn_info;
+
+	sim->transactions++;
+	memset(sim->latch, SIM_STALE, sizeof(sim->latch));
+
+	for (size_t i = 0; i < size; i++) {
+		if (!is_cmd) {
+			sim->data_bytes++;
+			*cursor(sim) = buffer[i];
+			advance(sim);
+			continue;
+		}
+
+		sim->cmd_bytes++;
+		if (sim->cmd_len == 0)
+			sim->cmd_need = args_for(buffer[i]);
+		sim->cmd[sim->cmd_len++] = buffer[i];
+		if (sim->cmd_len > sim->cmd_need) {
+			run_command(sim);
+			sim->cmd_len = 0;
+		}
+	}
+	return true;
+}
+
+bool ssd1306_sim_read(void *conn_info, uint8_t *buffer, size_t size)
+{
+	ssd1306_sim *sim = (ssd1306_sim *)conn_info;
+	uint8_t latency = sim->read_latency;
+
+	sim->transactions++;
+	for (size_t i = 0; i < size; i++) {
+		sim->read_bytes++;
+		if (!latency) {
+			buffer[i] = *cursor(sim);
+		} else {
+			buffer[i] = sim->latch[0];
+			memmove(sim->latch, sim->latch + 1, latency - 1);
+			sim->latch[latency - 1] = *cursor(sim);
+		}
+		advance(sim);
+	}
+	return true;
+}
@@ -0,0 +1,62 @@
+#ifndef SSD1306_SIM_H
+#define SSD1306_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SSD1306_SIM_MAX_COLS 132
+#define SSD1306_SIM_MAX_PAGES 8
+#define SSD1306_SIM_MAX_LATENCY 4
+
+/*
+ * A host-side model of the controller's GDDRAM and address logic.
+ * Pass ssd1306_sim_write (and ssd1306_sim_read) to the library with a
+ * pointer to one of these as the connection info.
+ *
+ * Reads go through a latch that is read_latency bytes deep, like the
+ * real part: the first read_latency reads after the address is set or
+ * RAM is written return stale data.
+ */
+typedef struct ssd1306_sim {
+	uint8_t gddram[SSD1306_SIM_MAX_PAGES][SSD1306_SIM_MAX_COLS];
+	uint8_t ram_width;
+	uint8_t pages;
+
+	/* Address logic */
+	uint8_t mode;
+	uint8_t col, col_start, col_end;
+	uint8_t page, page_start, page_end;
+	uint8_t page_mode_col;
+
+	/* Read latch */
+	uint8_t read_latency;
+	uint8_t latch[SSD1306_SIM_MAX_LATENCY];
+
+	/* Partly received multi-byte command */
+	uint8_t cmd[8];
+	uint8_t cmd_len, cmd_need;
+
+	/* Display state, for checking what the driver asked for */
+	bool display_on;
+	bool inverted;
+	bool segment_remap;
+	bool com_scan_dec;
+	uint8_t contrast;
+
+	/* Traffic */
+	unsigned long transactions;
+	unsigned long cmd_bytes;
+	unsigned long data_bytes;
+	unsigned long read_bytes;
+} ssd1306_sim;
+
+void ssd1306_sim_init(ssd1306_sim *sim, uint8_t ram_width, uint8_t pages,
+		      uint8_t read_latency);
+
+bool ssd1306_sim_write(void *conn_info, const uint8_t *buffer, size_t size,
+		       bool is_cmd);
+
+bool ssd1306_sim_read(void *conn_info, uint8_t *buffer, size_t size);
+
+#endif
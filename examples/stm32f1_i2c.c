@@ -2,35 +2,57 @@
 #define SSD1306_STM32F1_I2C
 #include "stm32f1_i2c.h"
 
-void write(void *conn_info, uint8_t *buffer, size_t size, bool is_cmd)
+/* Roughly a few ms at 72 MHz, long enough for any byte at 100 kHz */
+#define I2C_TIMEOUT 100000
+
+/*
+ * Spins until cond holds.  Gives up on a NACK or after I2C_TIMEOUT
+ * tries, so a bad cable fails the transfer instead of hanging it.
+ */
+#define I2C_WAIT(cond)						\
+	do {							\
+		uint32_t spins = I2C_TIMEOUT;			\
+		while (!(cond)) {				\
+			if ((I2C_SR1(dev) & I2C_SR1_AF) || !--spins)	\
+				goto fail;			\
+		}						\
+	} while (0)
+
+bool write(void *conn_info, const uint8_t *buffer, size_t size, bool is_cmd)
 {
 	uint32_t dev = ((const i2c_info *)conn_info)->dev;
 	uint8_t addr = ((const i2c_info *)conn_info)->addr;
 
-	while ((I2C_SR2(dev) & I2C_SR2_BUSY)) {
-	}
+	I2C_WAIT(!(I2C_SR2(dev) & I2C_SR2_BUSY));
 		
 	i2c_send_start(dev);
 
 	/* Wait for master mode selected */
-	while (!((I2C_SR1(dev) & I2C_SR1_SB)
-		& (I2C_SR2(dev) & (I2C_SR2_MSL | I2C_SR2_BUSY))));
+	I2C_WAIT((I2C_SR1(dev) & I2C_SR1_SB)
+		& (I2C_SR2(dev) & (I2C_SR2_MSL | I2C_SR2_BUSY)));
 
 	i2c_send_7bit_address(dev, addr, I2C_WRITE);
 
 	/* Waiting for address is transferred. */
-	while (!(I2C_SR1(dev) & I2C_SR1_ADDR));
+	I2C_WAIT(I2C_SR1(dev) & I2C_SR1_ADDR);
 
 	/* Clearing ADDR condition sequence. */
 	(void)I2C_SR2(dev);
 		/* Send control byte */
 		i2c_send_data(dev, is_cmd ? 0x00 : 0x40);
-		while (!(I2C_SR1(dev) & (I2C_SR1_BTF)));
+		I2C_WAIT(I2C_SR1(dev) & (I2C_SR1_BTF));
 	for (size_t i = 0; i < size; i++) {
 		i2c_send_data(dev, buffer[i]);
-		while (!(I2C_SR1(dev) & (I2C_SR1_BTF)));
+		I2C_WAIT(I2C_SR1(dev) & (I2C_SR1_BTF));
 	}
 	i2c_send_stop(dev);
+	return true;
+
+fail:
+	/* Clear the NACK flag and release the bus for the retry */
+	I2C_SR1(dev) &= ~I2C_SR1_AF;
+	i2c_send_stop(dev);
+	return false;
 }
 
 #endif
@@ -8,6 +8,6 @@ typedef struct i2c_info {
 	uint8_t addr;
 } i2c_info;
 
-void write(void *conn_info, uint8_t *buffer, size_t size, bool is_cmd);
+bool write(void *conn_info, const uint8_t *buffer, size_t size, bool is_cmd);
 
 #endif
@@ -1,7 +1,11 @@
 #include <stdarg.h>
 #include <stdbool.h>
-#include <new>
 #include "ssd1306.h"
+#include "ssd1306_commands.h"
+
+#if SSD1306_ENABLE_ORIENTATION && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /*
  * A common (but still ugly) hack to count the number of arguments,
@@ -30,70 +34,9 @@
  */
 #define BYTE_COMMAND(cmd) uint8_t tmp = (cmd); command(&tmp, 1);
 
-/*
- * A simple macro to trim down long lines
- * when casting pointers and calling methods.
- */
-#define SSD1306_CALL_CPP(ssd1306, x) reinterpret_cast<SSD1306*>(ssd1306)->x
-
-/* Fundamental Commands */
-constexpr uint8_t SSD1306_SETCONTRAST = 0x81;
-constexpr uint8_t SSD1306_DISPLAYALLONRESUME = 0xA4;
-constexpr uint8_t SSD1306_DISPLAYALLON = 0xA5;
-constexpr uint8_t SSD1306_NORMALDISPLAY = 0xA6;
-constexpr uint8_t SSD1306_INVERTDISPLAY = 0xA7;
-constexpr uint8_t SSD1306_DISPLAYOFF = 0xAE;
-constexpr uint8_t SSD1306_DISPLAYON = 0xAF;
-/* Scrolling Commands */
-constexpr uint8_t SSD1306_RIGHT_HORIZ_SCROLL = 0x26;
-constexpr uint8_t SSD1306_LEFT_HORIZ_SCROLL = 0x27;
-constexpr uint8_t SSD1306_VERT_RIGHT_HORIZ_SCROLL = 0x29;
-constexpr uint8_t SSD1306_VERT_LEFT_HORIZ_SCROLL = 0x2A;
-constexpr uint8_t SSD1306_DEACTIVATE_SCROLL = 0x2E;
-constexpr uint8_t SSD1306_ACTIVATE_SCROLL = 0x2F;
-constexpr uint8_t SSD1306_SET_VERTICAL_SCROLL_AREA = 0xA3;
-/* Addressing Commands */
-constexpr uint8_t SSD1306_SETLOWCOLUMN = 0x00;
-constexpr uint8_t SSD1306_SETHIGHCOLUMN = 0x10;
-constexpr uint8_t SSD1306_MEMORYMODE = 0x20;
-constexpr uint8_t SSD1306_SETCOLUMNADDR = 0x21;
-constexpr uint8_t SSD1306_SETPAGEADDR = 0x22;
-constexpr uint8_t SSD1306_SETPAGESTARTADDR = 0xB0;
-/* Hardware Configuration Commands */
-constexpr uint8_t SSD1306_SETSTARTLINE = 0x40;
-constexpr uint8_t SSD1306_SEGREMAP = 0xA0;
-constexpr uint8_t SSD1306_SETMULTIPLEX = 0xA8;
-constexpr uint8_t SSD1306_COMSCANINC = 0xC0;
-constexpr uint8_t SSD1306_COMSCANDEC = 0xC8;
-constexpr uint8_t SSD1306_SETDISPLAYOFFSET = 0xD3;
-constexpr uint8_t SSD1306_SETCOMPINS = 0xDA;
-/* Timing Commands */
-constexpr uint8_t SSD1306_SETDISPLAYCLOCKDIV = 0xD5;
-constexpr uint8_t SSD1306_SETPRECHARGE = 0xD9;
-constexpr uint8_t SSD1306_SETVCOMDESELECT = 0xDB;
-constexpr uint8_t SSD1306_NOP = 0xE3;
-/* Advanced Graphics Commands */
-constexpr uint8_t SSD1306_FADE = 0x23;
-constexpr uint8_t SSD1306_ZOOM = 0xD6;
-/* Charge Pump Command */
-constexpr uint8_t SSD1306_CHARGEPUMP = 0x8D;
-
-
-
-size_t sizeof_ssd1306(void)
-{
-	return sizeof(SSD1306);
-}
-
-
-
-void new_ssd1306(void *ssd1306_obj, void *conn_info,
-			void (*write_ptr)(void *, uint8_t *, size_t, bool))
-{
-	new(ssd1306_obj) SSD1306(conn_info, write_ptr);
-}
 
 
+#if SSD1306_ENABLE_DEFAULT_INIT
 /* The default init code.  99% of the time you will use
  * this if you aren't doing anything particuarly crazy.
  */
@@ -101,247 +44,621 @@ void SSD1306::default_init(enum ssd1306_screen_type type,
 			   enum ssd1306_vccstate vs,
 			   enum ssd1306_addr_mode mode)
 {
-	uint8_t compins, cont, height, width;
-	switch (type) {
-		case ssd1306_128_32:
-			compins = 0x02;
-			cont = 0x8F;
-			height = 32;
-			width = 128;
-			break;
-		case ssd1306_128_64:
-			compins = 0x12;
-			cont = vs ?  0xCF : 0x9F;
-			height = 64;
-			width = 128;
-			break;
-		case ssd1306_96_16:
-			compins = 0x02;
-			cont = vs ? 0xAF : 0x10;
-			height = 16;
-			width = 96;
-			break;
-	}
-	display_power(0);
-	multiplex(height - 1);
-	display_offset(0);
-	start_line(0);
-	segment_remap(1);
-	com_scan_dir(0);
-	pins(compins);
-	contrast(cont);
-	display_clock_div(0x80);
-	charge_pump(vs);
-	
-	memory_mode(mode);
-	
-	if (mode == ssd1306_page_a) {
-		//TODO: set higher column start addr
-		//TODO: set page start addr
-	} else {
-		//TODO: set column addr
-		//TODO: set page addr
-	}
-	
-	precharge(vs ? 0xF1 : 0x22);
-	vcom_deselect(0x40);
-	display_all_on(1);
-	display_invert(0);
-	stop_scroll();
-	fade(SSD1306_DISABLE_FADE);
-	zoom(0);
+	panel_init(ssd1306_panel_for(type), vs, mode);
+}
+#endif /* SSD1306_ENABLE_DEFAULT_INIT */
+
+
+
+/*
+ * Sends the panel's init table in one transfer.  Parts that only have
+ * page addressing (SH1106) are left in it whatever mode is asked for.
+ */
+void SSD1306::panel_init(const struct ssd1306_panel *p,
+			 enum ssd1306_vccstate vs,
+			 enum ssd1306_addr_mode mode)
+{
+	panel = p;
+	if (!(p->addr_modes & SSD1306_MODE_BIT(mode)))
+		mode = ssd1306_page_a;
+	addr_mode = mode;
+
+	command(p->init[vs].cmds, p->init[vs].size);
+#if SSD1306_ENABLE_ORIENTATION
+	orient = ssd1306_rotate_0;
+#endif
+	if (p->addr_modes != SSD1306_MODE_BIT(ssd1306_page_a))
+		memory_mode(mode);
 	display_power(1);
 }
 
-void ssd1306_default_init(void *ssd1306,
-			  enum ssd1306_screen_type type,
-			  enum ssd1306_vccstate vs,
-			  enum ssd1306_addr_mode mode)
+
+
+bool SSD1306::write(const uint8_t *buffer, size_t size, bool is_cmd)
 {
-	SSD1306_CALL_CPP(ssd1306, default_init(type, vs, mode));
+#if SSD1306_ENABLE_READ
+	/* Any write leaves stale data in the controller's read latch */
+	read_primed = false;
+#endif
+	if (write_p(connection_info, buffer, size, is_cmd))
+		return true;
+#if SSD1306_ENABLE_RECOVERY
+	counters.errors++;
+#endif
+	return false;
 }
 
 
 
-void SSD1306::write(uint8_t *buffer, size_t size, bool is_cmd)
+bool SSD1306::command(const uint8_t *cmd, size_t cmd_size)
 {
-	write_p(connection_info, buffer, size, is_cmd);
+	return write(cmd, cmd_size, 1);
 }
 
 
 
-void SSD1306::command(uint8_t *cmd, size_t cmd_size)
+bool SSD1306::draw(const uint8_t *buffer, size_t buffer_size)
 {
-	write(cmd, cmd_size, 1);
+	return write(buffer, buffer_size, 0);
 }
 
 
 
-void SSD1306::draw(uint8_t *buffer, size_t buffer_size)
+/*
+ * Sends a whole frame (frame_width() * pages bytes, page-major) to the
+ * panel set up by panel_init(), using the quickest sequence the
+ * controller has.
+ */
+bool SSD1306::flush(const uint8_t *frame)
 {
-	write(buffer, buffer_size, 0);
+	if (!panel)
+		return false;
+	return flush_region(frame, 0, (frame_height() + 7) / 8 - 1,
+			    0, frame_width() - 1);
 }
 
-void ssd1306_draw(void *ssd1306, uint8_t *buffer, size_t buffer_size)
-{
-	SSD1306_CALL_CPP(ssd1306, draw(buffer, buffer_size));
+
+
+/*
+ * Sends pages first_page..last_page, columns first_col..last_col of a
+ * full frame.  Column numbers are panel columns; the RAM offset is
+ * added here.  Ranges that are backwards or run off the frame are
+ * refused.  If the transport reports an error, the pages that didn't
+ * make it are resent as set up by set_recovery().
+ */
+bool SSD1306::flush_region(const uint8_t *frame,
+			   uint8_t first_page, uint8_t last_page,
+			   uint8_t first_col, uint8_t last_col)
+{
+	if (!panel || first_page > last_page || first_col > last_col ||
+	    last_page >= (frame_height() + 7) / 8 || last_col >= frame_width())
+		return false;
+
+	if (transposed()) {
+		/* Frame pages run across the panel, frame columns down it */
+		uint8_t page = first_page;
+		uint8_t end = last_page;
+		first_page = first_col / 8;
+		last_page = last_col / 8;
+		first_col = page * 8;
+		last_col = end * 8 + 7;
+	}
+
+	bool ok = send_region(frame, first_page, last_page, first_col, last_col);
+#if SSD1306_ENABLE_RECOVERY
+	if (!ok)
+		ok = repair(frame);
+#endif
+	return ok;
 }
 
 
 
-void SSD1306::display_power(bool power)
-{
-	COMMAND(power ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+/*
+ * Records which pages are known to hold what the host last sent.  A
+ * page only becomes confirmed when all of its columns went out.
+ */
+void SSD1306::mark_pages(uint8_t first_page, uint8_t last_page, bool ok,
+			 bool whole_rows)
+{
+#if SSD1306_ENABLE_RECOVERY
+	uint8_t bits = (uint8_t)(((1u << (last_page - first_page + 1)) - 1)
+				 << first_page);
+	if (!ok)
+		unconfirmed |= bits;
+	else if (whole_rows)
+		unconfirmed &= ~bits;
+#else
+	(void)first_page; (void)last_page; (void)ok; (void)whole_rows;
+#endif
+}
+
+
+
+/* One attempt at sending a region, without any retrying */
+bool SSD1306::send_region(const uint8_t *frame,
+			  uint8_t first_page, uint8_t last_page,
+			  uint8_t first_col, uint8_t last_col)
+{
+	const uint8_t width = panel->width;
+	const uint8_t start = column_base() + first_col;
+	const uint8_t end = column_base() + last_col;
+	const size_t run = last_col - first_col + 1;
+	const bool whole_rows = run == width;
+
+	if (addr_mode == ssd1306_horiz_a) {
+		/* One window, then the rows back to back as it wraps */
+		INIT_COMMAND(SSD1306_SETCOLUMNADDR, start, end,
+			     SSD1306_SETPAGEADDR, first_page, last_page);
+		bool ok = SEND_COMMAND();
+		if (ok && whole_rows && !transposed()) {
+			ok = draw(frame + first_page * width,
+				  run * (last_page - first_page + 1));
+		} else if (ok) {
+			for (uint8_t page = first_page; ok && page <= last_page; page++) {
+				ok = draw_row(frame, page, first_col, run);
+				if (!ok)
+					first_page = page;
+			}
+		}
+		/* Past a failure the window pointer is lost, so the rest is too */
+		mark_pages(first_page, last_page, ok, whole_rows);
+		return ok;
+	}
+
+	bool all_ok = true;
+	for (uint8_t page = first_page; page <= last_page; page++) {
+		bool ok;
+		if (addr_mode == ssd1306_page_a) {
+			INIT_COMMAND((uint8_t)(SSD1306_SETPAGESTARTADDR | page),
+				     (uint8_t)(SSD1306_SETLOWCOLUMN | (start & 0x0F)),
+				     (uint8_t)(SSD1306_SETHIGHCOLUMN | (start >> 4)));
+			ok = SEND_COMMAND();
+		} else {
+			/* Vertical mode: a one-page window fills column by column */
+			INIT_COMMAND(SSD1306_SETCOLUMNADDR, start, end,
+				     SSD1306_SETPAGEADDR, page, page);
+			ok = SEND_COMMAND();
+		}
+		ok = ok && draw_row(frame, page, first_col, run);
+		mark_pages(page, page, ok, whole_rows);
+		all_ok = all_ok && ok;
+	}
+	return all_ok;
 }
 
-void ssd1306_display_power(void *ssd1306, bool power)
-{
-	SSD1306_CALL_CPP(ssd1306, display_power(power));
+
+
+#if SSD1306_ENABLE_ORIENTATION
+/*
+ * Transposes a run of 8x8 pixel blocks, the nth at src + n * stride,
+ * into consecutive 8-byte groups at dst: bit r of byte i becomes bit i
+ * of byte r.
+ */
+static void transpose_blocks(const uint8_t *src, size_t stride,
+			     uint8_t *dst, uint8_t blocks)
+{
+#ifdef __SSE2__
+	/* Two blocks per pass: the top bit of all 16 bytes is one movemask */
+	for (; blocks >= 2; blocks -= 2) {
+		__m128i v = _mm_unpacklo_epi64(
+			_mm_loadl_epi64((const __m128i *)src),
+			_mm_loadl_epi64((const __m128i *)(src + stride)));
+		for (int bit = 7; bit >= 0; bit--) {
+			int m = _mm_movemask_epi8(v);
+			dst[bit] = (uint8_t)m;
+			dst[8 + bit] = (uint8_t)(m >> 8);
+			v = _mm_add_epi8(v, v);
+		}
+		src += 2 * stride;
+		dst += 16;
+	}
+#endif
+	/* Hacker's Delight transpose8, with the block held in one word */
+	for (; blocks; blocks--) {
+		uint64_t x = 0;
+		for (int i = 0; i < 8; i++)
+			x |= (uint64_t)src[i] << (8 * i);
+
+		uint64_t t;
+		t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+		x ^= t ^ (t << 7);
+		t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+		x ^= t ^ (t << 14);
+		t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+		x ^= t ^ (t << 28);
+
+		for (int i = 0; i < 8; i++)
+			dst[i] = (uint8_t)(x >> (8 * i));
+		src += stride;
+		dst += 8;
+	}
 }
 
 
 
-void SSD1306::display_all_on(bool resume_from_ram)
+/*
+ * Mirroring and 180 degrees only change the segment remap and COM scan
+ * direction, so GDDRAM stays valid as long as the panel sits in the
+ * middle of the RAM.  One that doesn't (the 96x16, at column 0 of 128)
+ * moves to other RAM columns when the remap flips.  90 and 270 are a
+ * transpose in flush() plus one of those flips; the frame has to be
+ * redrawn at the new size.  Returns true when the panel needs a flush()
+ * to show the frame again.  Assumes the init table set remap 1 and COM
+ * scan decrementing, like all the built-in ones.
+ */
+bool SSD1306::orientation(enum ssd1306_orientation o)
 {
-	
-	COMMAND(resume_from_ram ? SSD1306_DISPLAYALLONRESUME : SSD1306_DISPLAYALLON);
+	bool remap = o == ssd1306_rotate_0 || o == ssd1306_rotate_270 ||
+		     o == ssd1306_mirror_y;
+	bool scan_dec = o == ssd1306_rotate_0 || o == ssd1306_rotate_90 ||
+			o == ssd1306_mirror_x;
+	bool was_transposed = transposed();
+	uint8_t was_base = panel ? column_base() : 0;
+
+	orient = o;
+	COMMAND((uint8_t)(SSD1306_SEGREMAP | remap),
+		scan_dec ? SSD1306_COMSCANDEC : SSD1306_COMSCANINC);
+	return transposed() != was_transposed ||
+	       (panel && column_base() != was_base);
 }
+#endif /* SSD1306_ENABLE_ORIENTATION */
+
 
-void ssd1306_display_all_on(void *ssd1306, bool resume_from_ram)
+
+/*
+ * The first RAM column of the panel.  With the segment remap flipped
+ * the panel sits at the other end of a RAM that is wider than it.
+ */
+uint8_t SSD1306::column_base(void) const
 {
-	SSD1306_CALL_CPP(ssd1306, display_all_on(resume_from_ram));
+#if SSD1306_ENABLE_ORIENTATION
+	if (orient == ssd1306_rotate_90 || orient == ssd1306_rotate_180 ||
+	    orient == ssd1306_mirror_x)
+		return panel->ram_width - panel->width - panel->column_offset;
+#endif
+	return panel->column_offset;
 }
 
 
 
-void SSD1306::display_invert(bool inverted)
-{
-	COMMAND(inverted ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY);
+/*
+ * Sends columns first_col.. of one panel page.  When the frame is
+ * turned 90 or 270 degrees the bytes are transposed out of it first.
+ */
+bool SSD1306::draw_row(const uint8_t *frame, uint8_t page,
+		       uint8_t first_col, size_t run)
+{
+#if SSD1306_ENABLE_ORIENTATION
+	if (transposed()) {
+		/* Panels are at most 128 columns wide */
+		uint8_t row[128];
+		uint8_t block = first_col / 8;
+		uint8_t blocks = (uint8_t)((first_col + run + 7) / 8 - block);
+		transpose_blocks(frame + block * panel->height + page * 8,
+				 panel->height, row, blocks);
+		return draw(row + (first_col & 0x07), run);
+	}
+#endif
+	return draw(frame + page * panel->width + first_col, run);
 }
 
-void ssd1306_display_invert(void *ssd1306, bool inverted)
+
+
+#if SSD1306_ENABLE_RECOVERY
+void SSD1306::set_recovery(ssd1306_delay_fn delay_ptr, uint8_t retries,
+			   uint16_t backoff_ms)
 {
-	SSD1306_CALL_CPP(ssd1306, display_invert(inverted));
+	delay_p = delay_ptr;
+	max_retries = retries;
+	retry_backoff = backoff_ms;
 }
 
 
 
-void SSD1306::display_clock_div(uint8_t div, uint8_t freq)
-{
-	COMMAND(SSD1306_SETDISPLAYCLOCKDIV, (freq << 4) | (0x0F & div));
+/*
+ * Resends every unconfirmed page of frame, backing off between passes.
+ * Runs of neighbouring pages go out as one region.
+ */
+bool SSD1306::repair(const uint8_t *frame)
+{
+	if (!panel)
+		return false;
+
+	const uint8_t pages = panel_pages();
+	uint16_t backoff = retry_backoff;
+
+	for (uint8_t attempt = 0; unconfirmed && attempt < max_retries; attempt++) {
+		counters.retries++;
+		if (delay_p && backoff)
+			delay_p(connection_info, backoff);
+		if (backoff < 0x8000)
+			backoff *= 2;
+
+		uint8_t page = 0;
+		while (page < pages) {
+			if (!(unconfirmed & (1 << page))) {
+				page++;
+				continue;
+			}
+			uint8_t last = page;
+			while (last + 1 < pages && (unconfirmed & (1 << (last + 1))))
+				last++;
+			counters.resent_pages += last - page + 1;
+			send_region(frame, page, last, 0, panel->width - 1);
+			page = last + 1;
+		}
+	}
+	return !unconfirmed;
 }
 
-void ssd1306_display_clock_div(void *ssd1306, uint8_t div, uint8_t freq)
+
+
+/*
+ * Rewrites one page of frame per call, to be run from an idle loop or
+ * timer.  Unconfirmed pages go first; otherwise it walks the panel so
+ * corruption that the transport never saw gets fixed eventually.
+ */
+bool SSD1306::refresh_step(const uint8_t *frame)
 {
-	SSD1306_CALL_CPP(ssd1306, display_clock_div(div, freq));
+	if (!panel)
+		return false;
+
+	const uint8_t pages = panel_pages();
+	uint8_t page = refresh_page;
+
+	if (unconfirmed) {
+		for (page = 0; !(unconfirmed & (1 << page)); page++)
+			;
+	} else {
+		refresh_page = (refresh_page + 1) % pages;
+	}
+
+	counters.refreshes++;
+	return send_region(frame, page, page, 0, panel->width - 1);
 }
+#endif /* SSD1306_ENABLE_RECOVERY */
 
 
 
-void SSD1306::display_offset(uint8_t offset)
+#if SSD1306_ENABLE_READ
+void SSD1306::set_read(ssd1306_read_fn read_ptr, uint8_t dummy)
 {
-	COMMAND(SSD1306_SETDISPLAYOFFSET, offset);
+	read_p = read_ptr;
+	dummy_reads = dummy;
+	read_primed = false;
 }
 
-void ssd1306_display_offset(void *ssd1306, uint8_t offset)
+
+
+/*
+ * Reads GDDRAM from the current address.  The controller hands back
+ * stale data for the first read(s) after the address is set or RAM is
+ * written, so those are thrown away here.  Back-to-back reads carry on
+ * where the last one stopped without more dummies.
+ */
+bool SSD1306::read(uint8_t *buffer, size_t size)
 {
-	SSD1306_CALL_CPP(ssd1306, display_offset(offset));
+	if (!read_p)
+		return false;
+
+	if (!read_primed) {
+		uint8_t dummy;
+		for (uint8_t i = 0; i < dummy_reads; i++)
+			if (!read_p(connection_info, &dummy, 1))
+				return false;
+		read_primed = true;
+	}
+	return read_p(connection_info, buffer, size);
 }
 
 
 
-void SSD1306::multiplex(uint8_t mux)
+/*
+ * Points the controller at RAM columns start..end of one page, with the
+ * page-mode cursor on parts (or in modes) that have no window commands.
+ */
+bool SSD1306::set_cursor(uint8_t page, uint8_t start, uint8_t end)
 {
-	COMMAND(SSD1306_SETMULTIPLEX, mux);
+	if (addr_mode == ssd1306_page_a) {
+		INIT_COMMAND((uint8_t)(SSD1306_SETPAGESTARTADDR | page),
+			     (uint8_t)(SSD1306_SETLOWCOLUMN | (start & 0x0F)),
+			     (uint8_t)(SSD1306_SETHIGHCOLUMN | (start >> 4)));
+		return SEND_COMMAND();
+	}
+	INIT_COMMAND(SSD1306_SETCOLUMNADDR, start, end,
+		     SSD1306_SETPAGEADDR, page, page);
+	return SEND_COMMAND();
 }
 
-void ssd1306_multiplex(void *ssd1306, uint8_t mux)
+
+
+/*
+ * Read-modify-write of columns start_col..end_col on one page, done in
+ * GDDRAM so no host framebuffer is needed.  Each byte becomes
+ * (byte & and_mask) ^ xor_mask.  Columns are panel columns, like
+ * flush_region(), so the RAM offset and any mirroring are applied here.
+ * Leaves the column and page windows changed.
+ */
+bool SSD1306::modify(uint8_t page, uint8_t start_col, uint8_t end_col,
+		     uint8_t and_mask, uint8_t xor_mask)
 {
-	SSD1306_CALL_CPP(ssd1306, multiplex(mux));
+	if (!read_p || !panel || start_col > end_col ||
+	    end_col >= panel->width || page >= panel_pages())
+		return false;
+
+	const uint8_t base = column_base();
+	uint8_t chunk[16];
+
+	while (true) {
+		uint8_t last = ((size_t)(end_col - start_col) >= sizeof(chunk)) ?
+			       start_col + sizeof(chunk) - 1 : end_col;
+		size_t count = last - start_col + 1;
+
+		if (!set_cursor(page, base + start_col, base + last) ||
+		    !read(chunk, count))
+			return false;
+		for (size_t i = 0; i < count; i++)
+			chunk[i] = (chunk[i] & and_mask) ^ xor_mask;
+
+		/* Reading (and any prefetch) moved the column pointer on */
+		if (!set_cursor(page, base + start_col, base + last) ||
+		    !draw(chunk, count))
+			return false;
+
+		if (last == end_col)
+			break;
+		start_col = last + 1;
+	}
+	return true;
 }
 
 
 
-void SSD1306::charge_pump(enum ssd1306_vccstate en)
+/* x and y are frame coordinates, so they follow orientation() */
+bool SSD1306::draw_pixel(uint8_t x, uint8_t y, bool on)
 {
-	uint8_t tmp = en ? 0x14 : 0x10;
-	COMMAND(SSD1306_CHARGEPUMP, tmp);
+	if (transposed()) {
+		uint8_t t = x;
+		x = y;
+		y = t;
+	}
+	uint8_t bit = 1 << (y & 0x07);
+	return modify(y >> 3, x, x, (uint8_t)~bit, on ? bit : 0);
 }
+#endif /* SSD1306_ENABLE_READ */
+
 
-void ssd1306_charge_pump(void *ssd1306, enum ssd1306_vccstate en)
+
+#if SSD1306_ENABLE_BITMAP
+/*
+ * Uncompressed bitmaps go out straight from flash.  RLE bitmaps are
+ * expanded into a small stack chunk and streamed, so no full-frame
+ * copy is ever made.  Stops at the first chunk the bus refuses.
+ */
+bool SSD1306::draw_bitmap(const struct ssd1306_bitmap *bmp)
+{
+	if (!bmp->rle)
+		return draw(bmp->data, bmp->size);
+
+	uint8_t chunk[16];
+	size_t fill = 0;
+	const uint8_t *src = bmp->data;
+	const uint8_t *end = bmp->data + bmp->size;
+
+	while (src < end) {
+		uint8_t ctrl = *src++;
+		bool run = ctrl >= SSD1306_RLE_RUN;
+		size_t count = run ? ctrl - SSD1306_RLE_RUN + SSD1306_RLE_MIN_RUN
+				   : ctrl + 1;
+
+		while (count--) {
+			chunk[fill++] = *src;
+			if (!run)
+				src++;
+			if (fill == sizeof(chunk)) {
+				if (!draw(chunk, fill))
+					return false;
+				fill = 0;
+			}
+		}
+		if (run)
+			src++;
+	}
+	return !fill || draw(chunk, fill);
+}
+#endif /* SSD1306_ENABLE_BITMAP */
+
+
+
+void SSD1306::display_power(bool power)
 {
-	SSD1306_CALL_CPP(ssd1306, charge_pump(en));
+	COMMAND(power ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
 }
 
 
 
-void SSD1306::precharge(uint8_t arg1)
+void SSD1306::display_all_on(bool resume_from_ram)
 {
-	COMMAND(SSD1306_SETPRECHARGE, arg1);
+	
+	COMMAND(resume_from_ram ? SSD1306_DISPLAYALLONRESUME : SSD1306_DISPLAYALLON);
 }
 
-void ssd1306_precharge(void *ssd1306, uint8_t arg1)
+
+
+void SSD1306::display_invert(bool inverted)
 {
-	SSD1306_CALL_CPP(ssd1306, precharge(arg1));
+	COMMAND(inverted ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY);
 }
 
 
 
-void SSD1306::pins(uint8_t arg1)
+void SSD1306::display_clock_div(uint8_t div, uint8_t freq)
 {
-	COMMAND(SSD1306_SETCOMPINS, arg1);
+	COMMAND(SSD1306_SETDISPLAYCLOCKDIV, (uint8_t)((freq << 4) | (0x0F & div)));
 }
 
-void ssd1306_pins(void *ssd1306, uint8_t arg1)
+
+
+void SSD1306::display_offset(uint8_t offset)
 {
-	SSD1306_CALL_CPP(ssd1306, pins(arg1));
+	COMMAND(SSD1306_SETDISPLAYOFFSET, offset);
 }
 
 
 
-void SSD1306::contrast(uint8_t contr)
+void SSD1306::multiplex(uint8_t mux)
 {
-	COMMAND(SSD1306_SETCONTRAST, contr);
+	COMMAND(SSD1306_SETMULTIPLEX, mux);
 }
 
-void ssd1306_contrast(void *ssd1306, uint8_t contr)
+
+
+void SSD1306::charge_pump(enum ssd1306_vccstate en)
 {
-	SSD1306_CALL_CPP(ssd1306, contrast(contr));
+	uint8_t tmp = en ? 0x14 : 0x10;
+	COMMAND(SSD1306_CHARGEPUMP, tmp);
 }
 
 
 
-void SSD1306::memory_mode(enum ssd1306_addr_mode mode)
+void SSD1306::precharge(uint8_t arg1)
 {
-	uint8_t tmp = (uint8_t)mode;
-	COMMAND(SSD1306_MEMORYMODE, tmp);
+	COMMAND(SSD1306_SETPRECHARGE, arg1);
 }
 
-void ssd1306_memory_mode(void *ssd1306, enum ssd1306_addr_mode mode)
+
+
+void SSD1306::pins(uint8_t arg1)
 {
-	SSD1306_CALL_CPP(ssd1306, memory_mode(mode));
+	COMMAND(SSD1306_SETCOMPINS, arg1);
 }
 
 
 
-void SSD1306::segment_remap(bool remap)
+void SSD1306::contrast(uint8_t contr)
 {
-	BYTE_COMMAND(SSD1306_SEGREMAP | (0x01 & arg1));
+	COMMAND(SSD1306_SETCONTRAST, contr);
 }
 
-void ssd1306_segment_remap(void *ssd1306, bool remap)
+
+
+void SSD1306::memory_mode(enum ssd1306_addr_mode mode)
 {
-	SSD1306_CALL_CPP(ssd1306, segment_remap(arg1));
+	uint8_t tmp = (uint8_t)mode;
+	COMMAND(SSD1306_MEMORYMODE, tmp);
 }
 
-void SSD1306::low_column(uint8_t column)
+
+
+void SSD1306::segment_remap(bool remap)
 {
-	BYTE_COMMAND(0x0F & column);
+	BYTE_COMMAND(SSD1306_SEGREMAP | (0x01 & remap));
 }
 
-void ssd1306_low_column(void *ssd1306, uint8_t column)
+void SSD1306::low_column(uint8_t column)
 {
-	SSD1306_CALL_CPP(ssd1306, low_column(column));
+	BYTE_COMMAND(0x0F & column);
 }
 
 
@@ -351,11 +668,6 @@ void SSD1306::high_column(uint8_t column)
 	BYTE_COMMAND(SSD1306_SETHIGHCOLUMN | (0x0F & column));
 }
 
-void ssd1306_high_column(void *ssd1306, uint8_t column)
-{
-	SSD1306_CALL_CPP(ssd1306, high_column(column));
-}
-
 
 
 void SSD1306::column_addr(uint8_t start_addr, uint8_t end_addr)
@@ -363,33 +675,18 @@ void SSD1306::column_addr(uint8_t start_addr, uint8_t end_addr)
 	COMMAND(SSD1306_SETCOLUMNADDR, start_addr, end_addr);
 }
 
-void ssd1306_column_addr(void *ssd1306, uint8_t start_addr, uint8_t end_addr)
-{
-	SSD1306_CALL_CPP(ssd1306, column_addr(start_addr, end_addr));
-}
-
 
 
 void SSD1306::page_addr(uint8_t start_addr, uint8_t end_addr)
 {
-	COMMAND(SSD1306_SETCOLUMNADDR, start_addr, end_addr);
-}
-
-void ssd1306_page_addr(void *ssd1306, uint8_t start_addr, uint8_t end_addr)
-{
-	SSD1306_CALL_CPP(ssd1306, page_addr(start_addr, end_addr));
+	COMMAND(SSD1306_SETPAGEADDR, start_addr, end_addr);
 }
 
 
 
 void SSD1306::page_start_addr(uint8_t start_addr)
 {
-	BYTE_COMMAND(SSD1306_SETPAGESTARTADDR | (0xF8 & start_addr));
-}
-
-void ssd1306_page_start_addr(void *ssd1306, uint8_t start_addr)
-{
-	SSD1306_CALL_CPP(ssd1306, page_start_addr(start_addr));
+	BYTE_COMMAND(SSD1306_SETPAGESTARTADDR | (0x07 & start_addr));
 }
 
 
@@ -399,11 +696,6 @@ void SSD1306::vcom_deselect(uint8_t arg1)
 	COMMAND(SSD1306_SETVCOMDESELECT, arg1);
 }
 
-void ssd1306_vcom_deselect(void *ssd1306, uint8_t arg1)
-{
-	SSD1306_CALL_CPP(ssd1306, vcom_deselect(arg1));
-}
-
 
 
 void SSD1306::com_scan_dir(uint8_t arg1)
@@ -411,11 +703,6 @@ void SSD1306::com_scan_dir(uint8_t arg1)
 	COMMAND(arg1 ? SSD1306_COMSCANINC : SSD1306_COMSCANDEC);
 }
 
-void ssd1306_com_scan_dir(void *ssd1306, uint8_t arg1)
-{
-	SSD1306_CALL_CPP(ssd1306, com_scan_dir(arg1));
-}
-
 
 
 void SSD1306::start_line(uint8_t line)
@@ -423,23 +710,14 @@ void SSD1306::start_line(uint8_t line)
 	BYTE_COMMAND(SSD1306_SETSTARTLINE | (0x3F & line));
 }
 
-void ssd1306_start_line(void *ssd1306, uint8_t line)
-{
-	SSD1306_CALL_CPP(ssd1306,  start_line(line));
-}
-
 
 
+#if SSD1306_ENABLE_SCROLL
 void SSD1306::activate_scroll(void)
 {
 	COMMAND(SSD1306_ACTIVATE_SCROLL);
 }
 
-void ssd1306_activate_scroll(void *ssd1306)
-{
-	SSD1306_CALL_CPP(ssd1306, activate_scroll());
-}
-
 
 //TODO: private?
 void SSD1306::vertical_scroll_area(uint8_t arg1, uint8_t arg2)
@@ -447,11 +725,6 @@ void SSD1306::vertical_scroll_area(uint8_t arg1, uint8_t arg2)
 	COMMAND(SSD1306_SET_VERTICAL_SCROLL_AREA, arg1, arg2);
 }
 
-void ssd1306_vertical_scroll_area(void *ssd1306, uint8_t arg1, uint8_t arg2)
-{
-	SSD1306_CALL_CPP(ssd1306, vertical_scroll_area(arg1, arg2));
-}
-
 
 
 void SSD1306::horizontal_scroll(enum ssd1306_scroll_mode mode,
@@ -489,11 +762,6 @@ void SSD1306::start_scroll(enum ssd1306_scroll_mode mode,
 			break;
 	}
 }
-
-void ssd1306_start_scroll(void *ssd1306,
-{
-	SSD1306_CALL_CPP(ssd1306, 
-}
 */
 
 
@@ -502,35 +770,23 @@ void SSD1306::stop_scroll(void)
 {
 	COMMAND(SSD1306_DEACTIVATE_SCROLL);
 }
-
-void ssd1306_stop_scroll(void *ssd1306)
-{
-	SSD1306_CALL_CPP(ssd1306, stop_scroll());
-}
+#endif /* SSD1306_ENABLE_SCROLL */
 
 
 
+#if SSD1306_ENABLE_FADE_ZOOM
 void SSD1306::fade(uint8_t mode_and_rate)
 {
 	COMMAND(SSD1306_FADE, mode_and_rate);
 }
 
-void ssd1306_fade(void *ssd1306, uint8_t mode_and_rate)
-{
-	SSD1306_CALL_CPP(ssd1306, fade(mode_and_rate));
-}
-
 
 
 void SSD1306::zoom(bool en)
 {
 	COMMAND(SSD1306_ZOOM, en);
 }
-
-void ssd1306_zoom(void *ssd1306, bool en)
-{
-	SSD1306_CALL_CPP(ssd1306, zoom(en));
-}
+#endif /* SSD1306_ENABLE_FADE_ZOOM */
 
 
 
@@ -538,8 +794,3 @@ void SSD1306::nop(void)
 {
 	COMMAND(SSD1306_NOP);
 }
-
-void ssd1306_nop(void *ssd1306)
-{
-	SSD1306_CALL_CPP(ssd1306, nop());
-}
@@ -3,8 +3,9 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
-
-//TODO: read
+#include "ssd1306_config.h"
+#include "ssd1306_asset.h"
+#include "ssd1306_panel.h"
 
 #define SSD1306_I2C_ADDR1 0x3C
 #define SSD1306_I2C_ADDR2 0x3D
@@ -49,24 +50,125 @@ enum ssd1306_vccstate {
 enum ssd1306_screen_type {
 	ssd1306_128_32,
 	ssd1306_128_64,
-	ssd1306_96_16
+	ssd1306_96_16,
+	ssd1306_64_48,
+	ssd1306_72_40,
+	sh1106_128_64,
+	ssd1309_128_64
+};
+
+/*
+ * How the panel is mounted, relative to the built-in init tables.
+ * Mirroring and 180 degrees are done by the controller.  90 and 270
+ * swap the frame's width and height, and flush() transposes it.
+ */
+enum ssd1306_orientation {
+	ssd1306_rotate_0,
+	ssd1306_rotate_90,
+	ssd1306_rotate_180,
+	ssd1306_rotate_270,
+	ssd1306_mirror_x,
+	ssd1306_mirror_y
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#if SSD1306_ENABLE_DEFAULT_INIT
+	/* The built-in descriptor for a screen type */
+	const struct ssd1306_panel *ssd1306_panel_for(enum ssd1306_screen_type type);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ * The platform write function.  buffer may point into flash
+ * (see ssd1306_asset.h), so it must never be written through.
+ * Returns false if the transfer failed (NACK, timeout, ...).
+ */
+typedef bool (*ssd1306_write_fn)(void *conn_info, const uint8_t *buffer,
+				 size_t size, bool is_cmd);
+
+/* Used to back off between retries, see set_recovery() */
+typedef void (*ssd1306_delay_fn)(void *conn_info, uint16_t ms);
+
+struct ssd1306_stats {
+	uint32_t errors;	/* transfers the transport reported as failed */
+	uint32_t retries;	/* repair passes */
+	uint32_t resent_pages;	/* pages resent by those passes */
+	uint32_t refreshes;	/* pages rewritten by refresh_step() */
 };
 
+/*
+ * The optional platform read function.  Reads size bytes of display data
+ * (D/C high).  Only the 6800/8080 parallel interfaces can read GDDRAM;
+ * the controller has no read path over I2C or SPI.  Returns false if
+ * nothing was read.
+ */
+typedef bool (*ssd1306_read_fn)(void *conn_info, uint8_t *buffer, size_t size);
+
 #ifdef  __cplusplus
 
 class SSD1306
 {
 
 public:
-	SSD1306(void *conn_info,
-		void (*write_ptr)(void *, uint8_t *, size_t, bool)) : 
-		connection_info(conn_info), write_p(write_ptr) {};
+	SSD1306(void *conn_info, ssd1306_write_fn write_ptr) : 
+		connection_info(conn_info), write_p(write_ptr),
+		panel(nullptr), addr_mode(ssd1306_page_a)
+#if SSD1306_ENABLE_ORIENTATION
+		, orient(ssd1306_rotate_0)
+#endif
+#if SSD1306_ENABLE_RECOVERY
+		, delay_p(nullptr), max_retries(3), retry_backoff(0),
+		unconfirmed(0), refresh_page(0), counters()
+#endif
+#if SSD1306_ENABLE_READ
+		, read_p(nullptr), dummy_reads(1), read_primed(false)
+#endif
+		{};
 		
+#if SSD1306_ENABLE_DEFAULT_INIT
 	void default_init(enum ssd1306_screen_type type,
 			  enum ssd1306_vccstate vs,
 			  enum ssd1306_addr_mode mode);
+#endif
+	void panel_init(const struct ssd1306_panel *p,
+			enum ssd1306_vccstate vs,
+			enum ssd1306_addr_mode mode);
 			  
-	void draw(uint8_t *buffer, size_t buffer_size);
+	bool draw(const uint8_t *buffer, size_t buffer_size);
+	bool flush(const uint8_t *frame);
+	bool flush_region(const uint8_t *frame,
+			  uint8_t first_page, uint8_t last_page,
+			  uint8_t first_col, uint8_t last_col);
+#if SSD1306_ENABLE_ORIENTATION
+	bool orientation(enum ssd1306_orientation o);
+#endif
+	/* The frame flush() takes, which is the panel turned by orientation() */
+	uint8_t frame_width(void) const
+		{ return transposed() ? panel->height : panel->width; }
+	uint8_t frame_height(void) const
+		{ return transposed() ? panel->width : panel->height; }
+#if SSD1306_ENABLE_RECOVERY
+	void set_recovery(ssd1306_delay_fn delay_ptr, uint8_t retries,
+			  uint16_t backoff_ms);
+	bool repair(const uint8_t *frame);
+	bool refresh_step(const uint8_t *frame);
+	uint8_t unconfirmed_pages(void) const { return unconfirmed; }
+	const struct ssd1306_stats *stats(void) const { return &counters; }
+#endif
+#if SSD1306_ENABLE_BITMAP
+	bool draw_bitmap(const struct ssd1306_bitmap *bmp);
+#endif
+#if SSD1306_ENABLE_READ
+	void set_read(ssd1306_read_fn read_ptr, uint8_t dummy_reads = 1);
+	bool read(uint8_t *buffer, size_t size);
+	bool modify(uint8_t page, uint8_t start_col, uint8_t end_col,
+		    uint8_t and_mask, uint8_t xor_mask);
+	bool draw_pixel(uint8_t x, uint8_t y, bool on);
+#endif
 	void display_power(bool power);
 	void display_all_on(bool resume_from_ram);
 	void display_invert(bool inverted);
@@ -87,9 +189,12 @@ public:
 	void vcom_deselect(uint8_t arg1); //TODO
 	void com_scan_dir(uint8_t arg1); //TODO
 	void start_line(uint8_t line);
+	void nop(void);
+#if SSD1306_ENABLE_FADE_ZOOM
 	void fade(uint8_t mode_and_rate); //See datasheet v1.5
 	void zoom(bool en); //See datasheet v1.5
-	void nop(void);
+#endif
+#if SSD1306_ENABLE_SCROLL
 	void activate_scroll(void);
 	void vertical_scroll_area(uint8_t arg1, uint8_t arg2); //TODO
 	void horizontal_scroll(enum ssd1306_scroll_mode mode,
@@ -102,6 +207,7 @@ public:
 					uint8_t stop_page,
 					enum ssd1306_time_interval interval);
 	void stop_scroll(void);
+#endif
 	/*void start_scroll(enum ssd1306_scroll_mode mode,
 				uint8_t start_page,
 				uint8_t stop_page,
@@ -109,16 +215,53 @@ public:
 	*/
 	
 private:
-	void command(uint8_t *cmd, size_t cmd_size);
-	void write(uint8_t *buffer, size_t size, bool is_cmd);
+	bool command(const uint8_t *cmd, size_t cmd_size);
+	bool write(const uint8_t *buffer, size_t size, bool is_cmd);
+	bool send_region(const uint8_t *frame,
+			 uint8_t first_page, uint8_t last_page,
+			 uint8_t first_col, uint8_t last_col);
+	void mark_pages(uint8_t first_page, uint8_t last_page, bool ok,
+			bool whole_rows);
+	bool draw_row(const uint8_t *frame, uint8_t page,
+		      uint8_t first_col, size_t run);
+	uint8_t panel_pages(void) const { return (panel->height + 7) / 8; }
+	uint8_t column_base(void) const;
+#if SSD1306_ENABLE_READ
+	bool set_cursor(uint8_t page, uint8_t start, uint8_t end);
+#endif
+#if SSD1306_ENABLE_ORIENTATION
+	bool transposed(void) const
+		{ return orient == ssd1306_rotate_90 || orient == ssd1306_rotate_270; }
+#else
+	bool transposed(void) const { return false; }
+#endif
 	
 	//TODO: Make const?
 	void *connection_info;
-	void (*write_p)(void *, uint8_t *, size_t, bool);
+	ssd1306_write_fn write_p;
+	const struct ssd1306_panel *panel;
+	enum ssd1306_addr_mode addr_mode;
+#if SSD1306_ENABLE_ORIENTATION
+	enum ssd1306_orientation orient;
+#endif
+#if SSD1306_ENABLE_RECOVERY
+	ssd1306_delay_fn delay_p;
+	uint8_t max_retries;
+	uint16_t retry_backoff;
+	uint8_t unconfirmed;
+	uint8_t refresh_page;
+	struct ssd1306_stats counters;
+#endif
+#if SSD1306_ENABLE_READ
+	ssd1306_read_fn read_p;
+	uint8_t dummy_reads;
+	bool read_primed;
+#endif
 };
 
 #endif /* __cplusplus */
 
+#if SSD1306_ENABLE_C_API
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -126,14 +269,72 @@ extern "C" {
 	size_t sizeof_ssd1306(void);
 	void new_ssd1306(void *ssd1306_obj,
 			 void *conn_info,
-			 void (*write_ptr)(void *, uint8_t *, size_t, bool));
+			 ssd1306_write_fn write_ptr);
 			
+#if SSD1306_ENABLE_DEFAULT_INIT
 	void ssd1306_default_init(void *ssd1306,
 				  enum ssd1306_screen_type type,
 				  enum ssd1306_vccstate vs,
 				  enum ssd1306_addr_mode mode);
+#endif
+
+	void ssd1306_panel_init(void *ssd1306,
+				const struct ssd1306_panel *panel,
+				enum ssd1306_vccstate vs,
+				enum ssd1306_addr_mode mode);
 				  
-	void ssd1306_draw(void *ssd1306, uint8_t *buffer, size_t buffer_size);
+	bool ssd1306_draw(void *ssd1306,
+			  const uint8_t *buffer,
+			  size_t buffer_size);
+
+	bool ssd1306_flush(void *ssd1306, const uint8_t *frame);
+
+	bool ssd1306_flush_region(void *ssd1306,
+				  const uint8_t *frame,
+				  uint8_t first_page,
+				  uint8_t last_page,
+				  uint8_t first_col,
+				  uint8_t last_col);
+
+#if SSD1306_ENABLE_ORIENTATION
+	bool ssd1306_orientation(void *ssd1306, enum ssd1306_orientation o);
+#endif
+	uint8_t ssd1306_frame_width(void *ssd1306);
+	uint8_t ssd1306_frame_height(void *ssd1306);
+
+#if SSD1306_ENABLE_RECOVERY
+	void ssd1306_set_recovery(void *ssd1306,
+				  ssd1306_delay_fn delay_ptr,
+				  uint8_t retries,
+				  uint16_t backoff_ms);
+
+	bool ssd1306_repair(void *ssd1306, const uint8_t *frame);
+	bool ssd1306_refresh_step(void *ssd1306, const uint8_t *frame);
+	uint8_t ssd1306_unconfirmed_pages(void *ssd1306);
+	const struct ssd1306_stats *ssd1306_stats(void *ssd1306);
+#endif
+
+#if SSD1306_ENABLE_BITMAP
+	bool ssd1306_draw_bitmap(void *ssd1306,
+				 const struct ssd1306_bitmap *bmp);
+#endif
+
+#if SSD1306_ENABLE_READ
+	void ssd1306_set_read(void *ssd1306,
+			      ssd1306_read_fn read_ptr,
+			      uint8_t dummy_reads);
+
+	bool ssd1306_read(void *ssd1306, uint8_t *buffer, size_t size);
+
+	bool ssd1306_modify(void *ssd1306,
+			    uint8_t page,
+			    uint8_t start_col,
+			    uint8_t end_col,
+			    uint8_t and_mask,
+			    uint8_t xor_mask);
+
+	bool ssd1306_draw_pixel(void *ssd1306, uint8_t x, uint8_t y, bool on);
+#endif
 	void ssd1306_display_power(void *ssd1306, bool power);
 	void ssd1306_display_all_on(void *ssd1306, bool resume_from_ram);
 	void ssd1306_display_invert(void *ssd1306, bool inverted);
@@ -165,9 +366,12 @@ extern "C" {
 	void ssd1306_vcom_deselect(void *ssd1306, uint8_t arg1); //TODO
 	void ssd1306_com_scan_dir(void *ssd1306, uint8_t arg1); //TODO
 	void ssd1306_start_line(void *ssd1306, uint8_t line);
+	void ssd1306_nop(void *ssd1306);
+#if SSD1306_ENABLE_FADE_ZOOM
 	void ssd1306_fade(void *ssd1306, uint8_t mode_and_rate);
 	void ssd1306_zoom(void *ssd1306, bool en);
-	void ssd1306_nop(void *ssd1306);
+#endif
+#if SSD1306_ENABLE_SCROLL
 	void ssd1306_activate_scroll(void *ssd1306);
 	
 	void ssd1306_vertical_scroll_area(void *ssd1306,
@@ -175,6 +379,7 @@ extern "C" {
 					  uint8_t arg2); //TODO
 	
 	void ssd1306_stop_scroll(void *ssd1306);
+#endif
 /*
 	void ssd306_start_scroll(void *ssd1306,
 				enum ssd1306_scroll_mode mode,
@@ -184,4 +389,5 @@ extern "C" {
 #ifdef __cplusplus
 }
 #endif
+#endif /* SSD1306_ENABLE_C_API */
 #endif /* SSD1306_H */
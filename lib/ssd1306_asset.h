@@ -0,0 +1,66 @@
+#ifndef SSD1306_ASSET_H
+#define SSD1306_ASSET_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Storage class for generated assets.  In C++ the arrays are constexpr
+ * so they land in .rodata (flash) with no startup copy.  C gets the
+ * closest equivalent.
+ */
+#ifdef __cplusplus
+#define SSD1306_ASSET constexpr
+#else
+#define SSD1306_ASSET static const
+#endif
+
+/*
+ * Run-length encoding used by tools/ssd1306_assets -c.
+ * A control byte below 0x80 is followed by (ctrl + 1) literal bytes.
+ * A control byte of 0x80 or above is followed by one byte that is
+ * repeated (ctrl - 0x80 + SSD1306_RLE_MIN_RUN) times.
+ */
+#define SSD1306_RLE_RUN		0x80
+#define SSD1306_RLE_MIN_RUN	2
+#define SSD1306_RLE_MAX_RUN	(0x7F + SSD1306_RLE_MIN_RUN)
+#define SSD1306_RLE_MAX_LITERAL	0x80
+
+/*
+ * A page-major image: one byte per column per page, LSB on top.
+ * This is the layout draw() expects, so an uncompressed bitmap
+ * can be sent straight from flash.
+ */
+struct ssd1306_bitmap {
+	uint16_t width;
+	uint8_t height;
+	uint8_t pages;
+	bool rle;
+	uint16_t size;		/* bytes in data, compressed or not */
+	const uint8_t *data;
+};
+
+/*
+ * A fixed-cell font.  Each glyph is width * pages bytes in the same
+ * page-major layout as ssd1306_bitmap, glyphs stored back to back
+ * starting at character code first.
+ */
+struct ssd1306_font {
+	uint8_t first;
+	uint8_t count;
+	uint8_t width;
+	uint8_t height;
+	uint8_t pages;
+	const uint8_t *data;
+};
+
+/* Returns the glyph for c, or NULL if the font does not contain it */
+static inline const uint8_t *ssd1306_glyph(const struct ssd1306_font *font,
+					   uint8_t c)
+{
+	if (c < font->first || c - font->first >= font->count)
+		return NULL;
+	return font->data + (size_t)(c - font->first) * font->width * font->pages;
+}
+
+#endif /* SSD1306_ASSET_H */
@@ -0,0 +1,376 @@
+#include "ssd1306.h"
+
+#if SSD1306_ENABLE_C_API
+#include <new>
+
+/*
+ * The extern "C" wrappers live in their own translation unit so C++-only
+ * builds don't pay for them.  Set SSD1306_ENABLE_C_API to 0 to drop them.
+ */
+
+/*
+ * A simple macro to trim down long lines
+ * when casting pointers and calling methods.
+ */
+#define SSD1306_CALL_CPP(ssd1306, x) reinterpret_cast<SSD1306*>(ssd1306)->x
+
+
+
+size_t sizeof_ssd1306(void)
+{
+	return sizeof(SSD1306);
+}
+
+
+
+void new_ssd1306(void *ssd1306_obj, void *conn_info,
+			ssd1306_write_fn write_ptr)
+{
+	new(ssd1306_obj) SSD1306(conn_info, write_ptr);
+}
+
+
+
+#if SSD1306_ENABLE_DEFAULT_INIT
+void ssd1306_default_init(void *ssd1306,
+			  enum ssd1306_screen_type type,
+			  enum ssd1306_vccstate vs,
+			  enum ssd1306_addr_mode mode)
+{
+	SSD1306_CALL_CPP(ssd1306, default_init(type, vs, mode));
+}
+#endif
+
+
+
+void ssd1306_panel_init(void *ssd1306,
+			const struct ssd1306_panel *panel,
+			enum ssd1306_vccstate vs,
+			enum ssd1306_addr_mode mode)
+{
+	SSD1306_CALL_CPP(ssd1306, panel_init(panel, vs, mode));
+}
+
+
+
+bool ssd1306_draw(void *ssd1306, const uint8_t *buffer, size_t buffer_size)
+{
+	return SSD1306_CALL_CPP(ssd1306, draw(buffer, buffer_size));
+}
+
+
+
+bool ssd1306_flush(void *ssd1306, const uint8_t *frame)
+{
+	return SSD1306_CALL_CPP(ssd1306, flush(frame));
+}
+
+
+
+bool ssd1306_flush_region(void *ssd1306, const uint8_t *frame,
+			  uint8_t first_page, uint8_t last_page,
+			  uint8_t first_col, uint8_t last_col)
+{
+	return SSD1306_CALL_CPP(ssd1306,
+		flush_region(frame, first_page, last_page, first_col, last_col));
+}
+
+
+
+#if SSD1306_ENABLE_ORIENTATION
+bool ssd1306_orientation(void *ssd1306, enum ssd1306_orientation o)
+{
+	return SSD1306_CALL_CPP(ssd1306, orientation(o));
+}
+#endif
+
+
+
+uint8_t ssd1306_frame_width(void *ssd1306)
+{
+	return SSD1306_CALL_CPP(ssd1306, frame_width());
+}
+
+
+
+uint8_t ssd1306_frame_height(void *ssd1306)
+{
+	return SSD1306_CALL_CPP(ssd1306, frame_height());
+}
+
+
+
+#if SSD1306_ENABLE_RECOVERY
+void ssd1306_set_recovery(void *ssd1306, ssd1306_delay_fn delay_ptr,
+			  uint8_t retries, uint16_t backoff_ms)
+{
+	SSD1306_CALL_CPP(ssd1306, set_recovery(delay_ptr, retries, backoff_ms));
+}
+
+
+
+bool ssd1306_repair(void *ssd1306, const uint8_t *frame)
+{
+	return SSD1306_CALL_CPP(ssd1306, repair(frame));
+}
+
+
+
+bool ssd1306_refresh_step(void *ssd1306, const uint8_t *frame)
+{
+	return SSD1306_CALL_CPP(ssd1306, refresh_step(frame));
+}
+
+
+
+uint8_t ssd1306_unconfirmed_pages(void *ssd1306)
+{
+	return SSD1306_CALL_CPP(ssd1306, unconfirmed_pages());
+}
+
+
+
+const struct ssd1306_stats *ssd1306_stats(void *ssd1306)
+{
+	return SSD1306_CALL_CPP(ssd1306, stats());
+}
+#endif /* SSD1306_ENABLE_RECOVERY */
+
+
+
+#if SSD1306_ENABLE_READ
+void ssd1306_set_read(void *ssd1306, ssd1306_read_fn read_ptr,
+		      uint8_t dummy_reads)
+{
+	SSD1306_CALL_CPP(ssd1306, set_read(read_ptr, dummy_reads));
+}
+
+
+
+bool ssd1306_read(void *ssd1306, uint8_t *buffer, size_t size)
+{
+	return SSD1306_CALL_CPP(ssd1306, read(buffer, size));
+}
+
+
+
+bool ssd1306_modify(void *ssd1306, uint8_t page, uint8_t start_col,
+		    uint8_t end_col, uint8_t and_mask, uint8_t xor_mask)
+{
+	return SSD1306_CALL_CPP(ssd1306,
+		modify(page, start_col, end_col, and_mask, xor_mask));
+}
+
+
+
+bool ssd1306_draw_pixel(void *ssd1306, uint8_t x, uint8_t y, bool on)
+{
+	return SSD1306_CALL_CPP(ssd1306, draw_pixel(x, y, on));
+}
+#endif /* SSD1306_ENABLE_READ */
+
+
+
+#if SSD1306_ENABLE_BITMAP
+bool ssd1306_draw_bitmap(void *ssd1306, const struct ssd1306_bitmap *bmp)
+{
+	return SSD1306_CALL_CPP(ssd1306, draw_bitmap(bmp));
+}
+#endif
+
+
+
+void ssd1306_display_power(void *ssd1306, bool power)
+{
+	SSD1306_CALL_CPP(ssd1306, display_power(power));
+}
+
+
+
+void ssd1306_display_all_on(void *ssd1306, bool resume_from_ram)
+{
+	SSD1306_CALL_CPP(ssd1306, display_all_on(resume_from_ram));
+}
+
+
+
+void ssd1306_display_invert(void *ssd1306, bool inverted)
+{
+	SSD1306_CALL_CPP(ssd1306, display_invert(inverted));
+}
+
+
+
+void ssd1306_display_clock_div(void *ssd1306, uint8_t div, uint8_t freq)
+{
+	SSD1306_CALL_CPP(ssd1306, display_clock_div(div, freq));
+}
+
+
+
+void ssd1306_display_offset(void *ssd1306, uint8_t offset)
+{
+	SSD1306_CALL_CPP(ssd1306, display_offset(offset));
+}
+
+
+
+void ssd1306_multiplex(void *ssd1306, uint8_t mux)
+{
+	SSD1306_CALL_CPP(ssd1306, multiplex(mux));
+}
+
+
+
+void ssd1306_charge_pump(void *ssd1306, enum ssd1306_vccstate en)
+{
+	SSD1306_CALL_CPP(ssd1306, charge_pump(en));
+}
+
+
+
+void ssd1306_precharge(void *ssd1306, uint8_t arg1)
+{
+	SSD1306_CALL_CPP(ssd1306, precharge(arg1));
+}
+
+
+
+void ssd1306_pins(void *ssd1306, uint8_t arg1)
+{
+	SSD1306_CALL_CPP(ssd1306, pins(arg1));
+}
+
+
+
+void ssd1306_contrast(void *ssd1306, uint8_t contr)
+{
+	SSD1306_CALL_CPP(ssd1306, contrast(contr));
+}
+
+
+
+void ssd1306_memory_mode(void *ssd1306, enum ssd1306_addr_mode mode)
+{
+	SSD1306_CALL_CPP(ssd1306, memory_mode(mode));
+}
+
+
+
+void ssd1306_segment_remap(void *ssd1306, bool remap)
+{
+	SSD1306_CALL_CPP(ssd1306, segment_remap(remap));
+}
+
+
+
+void ssd1306_low_column(void *ssd1306, uint8_t column)
+{
+	SSD1306_CALL_CPP(ssd1306, low_column(column));
+}
+
+
+
+void ssd1306_high_column(void *ssd1306, uint8_t column)
+{
+	SSD1306_CALL_CPP(ssd1306, high_column(column));
+}
+
+
+
+void ssd1306_column_addr(void *ssd1306, uint8_t start_addr, uint8_t end_addr)
+{
+	SSD1306_CALL_CPP(ssd1306, column_addr(start_addr, end_addr));
+}
+
+
+
+void ssd1306_page_addr(void *ssd1306, uint8_t start_addr, uint8_t end_addr)
+{
+	SSD1306_CALL_CPP(ssd1306, page_addr(start_addr, end_addr));
+}
+
+
+
+void ssd1306_page_start_addr(void *ssd1306, uint8_t start_addr)
+{
+	SSD1306_CALL_CPP(ssd1306, page_start_addr(start_addr));
+}
+
+
+
+void ssd1306_vcom_deselect(void *ssd1306, uint8_t arg1)
+{
+	SSD1306_CALL_CPP(ssd1306, vcom_deselect(arg1));
+}
+
+
+
+void ssd1306_com_scan_dir(void *ssd1306, uint8_t arg1)
+{
+	SSD1306_CALL_CPP(ssd1306, com_scan_dir(arg1));
+}
+
+
+
+void ssd1306_start_line(void *ssd1306, uint8_t line)
+{
+	SSD1306_CALL_CPP(ssd1306,  start_line(line));
+}
+
+
+
+#if SSD1306_ENABLE_SCROLL
+void ssd1306_activate_scroll(void *ssd1306)
+{
+	SSD1306_CALL_CPP(ssd1306, activate_scroll());
+}
+
+
+
+void ssd1306_vertical_scroll_area(void *ssd1306, uint8_t arg1, uint8_t arg2)
+{
+	SSD1306_CALL_CPP(ssd1306, vertical_scroll_area(arg1, arg2));
+}
+
+
+
+/*
+void ssd1306_start_scroll(void *ssd1306,
+{
+	SSD1306_CALL_CPP(ssd1306, 
+}
+*/
+
+
+
+void ssd1306_stop_scroll(void *ssd1306)
+{
+	SSD1306_CALL_CPP(ssd1306, stop_scroll());
+}
+#endif /* SSD1306_ENABLE_SCROLL */
+
+
+
+#if SSD1306_ENABLE_FADE_ZOOM
+void ssd1306_fade(void *ssd1306, uint8_t mode_and_rate)
+{
+	SSD1306_CALL_CPP(ssd1306, fade(mode_and_rate));
+}
+
+
+
+void ssd1306_zoom(void *ssd1306, bool en)
+{
+	SSD1306_CALL_CPP(ssd1306, zoom(en));
+}
+#endif /* SSD1306_ENABLE_FADE_ZOOM */
+
+
+
+void ssd1306_nop(void *ssd1306)
+{
+	SSD1306_CALL_CPP(ssd1306, nop());
+}
+
+#endif /* SSD1306_ENABLE_C_API */
@@ -0,0 +1,53 @@
+#ifndef SSD1306_COMMANDS_H
+#define SSD1306_COMMANDS_H
+#include <stdint.h>
+
+/* Command bytes, shared by the driver and the panel init tables */
+
+/* Fundamental Commands */
+constexpr uint8_t SSD1306_SETCONTRAST = 0x81;
+constexpr uint8_t SSD1306_DISPLAYALLONRESUME = 0xA4;
+constexpr uint8_t SSD1306_DISPLAYALLON = 0xA5;
+constexpr uint8_t SSD1306_NORMALDISPLAY = 0xA6;
+constexpr uint8_t SSD1306_INVERTDISPLAY = 0xA7;
+constexpr uint8_t SSD1306_DISPLAYOFF = 0xAE;
+constexpr uint8_t SSD1306_DISPLAYON = 0xAF;
+/* Scrolling Commands */
+constexpr uint8_t SSD1306_RIGHT_HORIZ_SCROLL = 0x26;
+constexpr uint8_t SSD1306_LEFT_HORIZ_SCROLL = 0x27;
+constexpr uint8_t SSD1306_VERT_RIGHT_HORIZ_SCROLL = 0x29;
+constexpr uint8_t SSD1306_VERT_LEFT_HORIZ_SCROLL = 0x2A;
+constexpr uint8_t SSD1306_DEACTIVATE_SCROLL = 0x2E;
+constexpr uint8_t SSD1306_ACTIVATE_SCROLL = 0x2F;
+constexpr uint8_t SSD1306_SET_VERTICAL_SCROLL_AREA = 0xA3;
+/* Addressing Commands */
+constexpr uint8_t SSD1306_SETLOWCOLUMN = 0x00;
+constexpr uint8_t SSD1306_SETHIGHCOLUMN = 0x10;
+constexpr uint8_t SSD1306_MEMORYMODE = 0x20;
+constexpr uint8_t SSD1306_SETCOLUMNADDR = 0x21;
+constexpr uint8_t SSD1306_SETPAGEADDR = 0x22;
+constexpr uint8_t SSD1306_SETPAGESTARTADDR = 0xB0;
+/* Hardware Configuration Commands */
+constexpr uint8_t SSD1306_SETSTARTLINE = 0x40;
+constexpr uint8_t SSD1306_SEGREMAP = 0xA0;
+constexpr uint8_t SSD1306_SETMULTIPLEX = 0xA8;
+constexpr uint8_t SSD1306_COMSCANINC = 0xC0;
+constexpr uint8_t SSD1306_COMSCANDEC = 0xC8;
+constexpr uint8_t SSD1306_SETDISPLAYOFFSET = 0xD3;
+constexpr uint8_t SSD1306_SETCOMPINS = 0xDA;
+/* Timing Commands */
+constexpr uint8_t SSD1306_SETDISPLAYCLOCKDIV = 0xD5;
+constexpr uint8_t SSD1306_SETPRECHARGE = 0xD9;
+constexpr uint8_t SSD1306_SETVCOMDESELECT = 0xDB;
+constexpr uint8_t SSD1306_NOP = 0xE3;
+/* Advanced Graphics Commands */
+constexpr uint8_t SSD1306_FADE = 0x23;
+constexpr uint8_t SSD1306_ZOOM = 0xD6;
+/* Charge Pump Command */
+constexpr uint8_t SSD1306_CHARGEPUMP = 0x8D;
+/* Internal current reference, 72x40 modules need it on */
+constexpr uint8_t SSD1306_SETIREF = 0xAD;
+/* SH1106: DC-DC converter control, takes the place of the charge pump */
+constexpr uint8_t SH1106_SETDCDC = 0xAD;
+
+#endif /* SSD1306_COMMANDS_H */
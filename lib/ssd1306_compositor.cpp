@@ -0,0 +1,262 @@
+#include <string.h>
+#include "ssd1306.h"
+#include "ssd1306_compositor.h"
+
+#if SSD1306_ENABLE_COMPOSITOR
+
+static inline int floor_div8(int v)
+{
+	return v >= 0 ? v / 8 : -((7 - v) / 8);
+}
+
+static inline void mark_clean(struct ssd1306_damage *damage, uint8_t page)
+{
+	damage->first[page] = 0xFF;
+	damage->last[page] = 0;
+}
+
+static inline bool is_dirty(const struct ssd1306_damage *damage, uint8_t page)
+{
+	return damage->first[page] <= damage->last[page];
+}
+
+bool ssd1306_damage_init(struct ssd1306_damage *damage, uint8_t width,
+			 uint8_t height)
+{
+	const uint8_t pages = (height + 7) / 8;
+
+	damage->width = width;
+	/* No pages means nothing is ever dirty, so misuse stays harmless */
+	damage->pages = 0;
+	if (pages > SSD1306_COMPOSITOR_MAX_PAGES)
+		return false;
+
+	damage->pages = pages;
+	for (uint8_t page = 0; page < pages; page++)
+		mark_clean(damage, page);
+	return true;
+}
+
+bool ssd1306_damage_add(struct ssd1306_damage *damage, int16_t x, int16_t y,
+			int16_t width, int16_t height)
+{
+	int x0 = x < 0 ? 0 : x;
+	int x1 = x + width - 1;
+	int y0 = y < 0 ? 0 : y;
+	int y1 = y + height - 1;
+
+	if (x1 >= damage->width)
+		x1 = damage->width - 1;
+	if (y1 >= damage->pages * 8)
+		y1 = damage->pages * 8 - 1;
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	for (int page = y0 / 8; page <= y1 / 8; page++) {
+		if (!is_dirty(damage, (uint8_t)page)) {
+			damage->first[page] = (uint8_t)x0;
+			damage->last[page] = (uint8_t)x1;
+			continue;
+		}
+		if (x0 < damage->first[page])
+			damage->first[page] = (uint8_t)x0;
+		if (x1 > damage->last[page])
+			damage->last[page] = (uint8_t)x1;
+	}
+	return true;
+}
+
+bool ssd1306_damage_pending(const struct ssd1306_damage *damage)
+{
+	for (uint8_t page = 0; page < damage->pages; page++)
+		if (is_dirty(damage, page))
+			return true;
+	return false;
+}
+
+/*
+ * Neighbouring pages with the same dirty columns go out as one window,
+ * which in horizontal mode is a single burst.
+ */
+bool ssd1306_damage_flush(struct ssd1306_damage *damage, const uint8_t *frame,
+			  void *ssd1306)
+{
+	SSD1306 *display = reinterpret_cast<SSD1306 *>(ssd1306);
+	bool ok = true;
+
+	uint8_t page = 0;
+	while (page < damage->pages) {
+		if (!is_dirty(damage, page)) {
+			page++;
+			continue;
+		}
+		uint8_t first = damage->first[page];
+		uint8_t last = damage->last[page];
+		uint8_t end = page;
+		while (end + 1 < damage->pages &&
+		       damage->first[end + 1] == first &&
+		       damage->last[end + 1] == last)
+			end++;
+
+		if (!display->flush_region(frame, page, end, first, last)) {
+			ok = false;
+			page = end + 1;
+			continue;
+		}
+		for (; page <= end; page++)
+			mark_clean(damage, page);
+	}
+	return ok;
+}
+
+
+
+bool ssd1306_compositor_init(struct ssd1306_compositor *comp, uint8_t *frame,
+			     uint8_t width, uint8_t height,
+			     struct ssd1306_layer *layers, uint8_t count)
+{
+	comp->layers = layers;
+	comp->frame = frame;
+	/* An empty compositor does nothing, so misuse stays harmless */
+	comp->count = 0;
+	if (!ssd1306_damage_init(&comp->damage, width, height))
+		return false;
+
+	comp->count = count;
+	ssd1306_damage_add(&comp->damage, 0, 0, width, height);
+	return true;
+}
+
+void ssd1306_compositor_damage(struct ssd1306_compositor *comp,
+			       int16_t x, int16_t y,
+			       int16_t width, int16_t height)
+{
+	ssd1306_damage_add(&comp->damage, x, y, width, height);
+}
+
+static inline void damage_layer(struct ssd1306_compositor *comp,
+				const struct ssd1306_layer *layer)
+{
+	if (layer->visible)
+		ssd1306_compositor_damage(comp, layer->x, layer->y,
+					  layer->width, layer->height);
+}
+
+void ssd1306_layer_move(struct ssd1306_compositor *comp,
+			struct ssd1306_layer *layer, int16_t x, int16_t y)
+{
+	if (layer->x == x && layer->y == y)
+		return;
+	damage_layer(comp, layer);
+	layer->x = x;
+	layer->y = y;
+	damage_layer(comp, layer);
+}
+
+void ssd1306_layer_show(struct ssd1306_compositor *comp,
+			struct ssd1306_layer *layer, bool visible)
+{
+	if (layer->visible == visible)
+		return;
+	layer->visible = true;
+	damage_layer(comp, layer);
+	layer->visible = visible;
+}
+
+void ssd1306_layer_changed(struct ssd1306_compositor *comp,
+			   struct ssd1306_layer *layer)
+{
+	damage_layer(comp, layer);
+}
+
+/*
+ * The byte of a layer that lines up with one panel page.  A layer that
+ * isn't page-aligned straddles two of its own pages, so those get
+ * stitched together with a shift.
+ */
+static inline uint8_t layer_byte(const uint8_t *data, uint8_t width,
+				 int lpages, int lpage, uint8_t shift, int lx)
+{
+	uint8_t lo = (lpage >= 0 && lpage < lpages) ? data[lpage * width + lx] : 0;
+	if (!shift)
+		return lo;
+	uint8_t hi = (lpage + 1 >= 0 && lpage + 1 < lpages) ?
+		     data[(lpage + 1) * width + lx] : 0;
+	return (uint8_t)((lo >> shift) | (hi << (8 - shift)));
+}
+
+static void compose_range(struct ssd1306_compositor *comp, uint8_t page,
+			  uint8_t first, uint8_t last)
+{
+	uint8_t *out = comp->frame + page * comp->damage.width;
+
+	memset(out + first, 0, last - first + 1);
+
+	for (uint8_t i = 0; i < comp->count; i++) {
+		const struct ssd1306_layer *layer = &comp->layers[i];
+		if (!layer->visible)
+			continue;
+
+		/* Layer row at the top of this page, split into page and shift */
+		int top = page * 8 - layer->y;
+		int lpage = floor_div8(top);
+		uint8_t shift = (uint8_t)(top - lpage * 8);
+		int lpages = (layer->height + 7) / 8;
+
+		/* Which rows of this page the layer covers at all */
+		uint8_t rows = 0;
+		for (int r = 0; r < 8; r++)
+			if (top + r >= 0 && top + r < layer->height)
+				rows |= 1 << r;
+		if (!rows)
+			continue;
+
+		int lo = layer->x > first ? layer->x : first;
+		int hi = layer->x + layer->width - 1;
+		if (hi > last)
+			hi = last;
+
+		for (int x = lo; x <= hi; x++) {
+			int lx = x - layer->x;
+			uint8_t src = layer_byte(layer->pixels, layer->width,
+						 lpages, lpage, shift, lx);
+			uint8_t m = rows;
+			if (layer->mask)
+				m &= layer_byte(layer->mask, layer->width,
+						lpages, lpage, shift, lx);
+
+			switch (layer->blend) {
+			case ssd1306_blend_copy:
+				out[x] = (uint8_t)((out[x] & ~m) | (src & m));
+				break;
+			case ssd1306_blend_or:
+				out[x] |= src & m;
+				break;
+			case ssd1306_blend_and:
+				out[x] &= (uint8_t)(src | ~m);
+				break;
+			case ssd1306_blend_xor:
+				out[x] ^= src & m;
+				break;
+			}
+		}
+	}
+}
+
+void ssd1306_compositor_compose(struct ssd1306_compositor *comp)
+{
+	const struct ssd1306_damage *damage = &comp->damage;
+
+	for (uint8_t page = 0; page < damage->pages; page++)
+		if (is_dirty(damage, page))
+			compose_range(comp, page, damage->first[page],
+				      damage->last[page]);
+}
+
+bool ssd1306_compositor_flush(struct ssd1306_compositor *comp, void *ssd1306)
+{
+	ssd1306_compositor_compose(comp);
+	return ssd1306_damage_flush(&comp->damage, comp->frame, ssd1306);
+}
+
+#endif /* SSD1306_ENABLE_COMPOSITOR */
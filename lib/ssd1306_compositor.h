@@ -0,0 +1,134 @@
+#ifndef SSD1306_COMPOSITOR_H
+#define SSD1306_COMPOSITOR_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "ssd1306_config.h"
+
+/*
+ * A layer compositor that works directly on page-major bytes.  Layers
+ * are stacked bottom first into a frame the size of the panel, and only
+ * the page/column ranges that changed are recomposed and sent.
+ */
+
+/* A 128-column panel turned 90 degrees makes a frame 128 pixels tall */
+#define SSD1306_COMPOSITOR_MAX_PAGES 16
+
+enum ssd1306_blend {
+	ssd1306_blend_copy,
+	ssd1306_blend_or,
+	ssd1306_blend_and,
+	ssd1306_blend_xor
+};
+
+/*
+ * pixels (and mask, if set) are width * ((height + 7) / 8) bytes in the
+ * same layout as the frame, e.g. an ssd1306_bitmap's data.  Only pixels
+ * whose mask bit is set take part in the blend.  x and y may put the
+ * layer partly or wholly off the panel.
+ */
+struct ssd1306_layer {
+	const uint8_t *pixels;
+	const uint8_t *mask;
+	uint8_t width;
+	uint8_t height;
+	int16_t x;
+	int16_t y;
+	enum ssd1306_blend blend;
+	bool visible;
+};
+
+/*
+ * Dirty columns per page of a frame: first > last means the page is
+ * clean.  The compositor keeps one, and anything else that sends a
+ * frame in pieces (e.g. examples/linux_fbd.c) can use it on its own.
+ */
+struct ssd1306_damage {
+	uint8_t width;
+	uint8_t pages;
+	uint8_t first[SSD1306_COMPOSITOR_MAX_PAGES];
+	uint8_t last[SSD1306_COMPOSITOR_MAX_PAGES];
+};
+
+struct ssd1306_compositor {
+	struct ssd1306_layer *layers;
+	uint8_t count;
+	uint8_t *frame;
+	struct ssd1306_damage damage;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if SSD1306_ENABLE_COMPOSITOR
+	/*
+	 * Starts with everything clean.  Fails for frames taller than
+	 * SSD1306_COMPOSITOR_MAX_PAGES pages.
+	 */
+	bool ssd1306_damage_init(struct ssd1306_damage *damage,
+				 uint8_t width,
+				 uint8_t height);
+
+	/*
+	 * Marks a rectangle of the frame, in pixels, clipped to it.
+	 * Returns false if none of it is on the frame.
+	 */
+	bool ssd1306_damage_add(struct ssd1306_damage *damage,
+				int16_t x, int16_t y,
+				int16_t width, int16_t height);
+
+	bool ssd1306_damage_pending(const struct ssd1306_damage *damage);
+
+	/*
+	 * Sends the dirty windows of frame through SSD1306::flush_region(),
+	 * merging neighbouring pages with the same columns into one window.
+	 * Windows that fail stay dirty for the next call.
+	 */
+	bool ssd1306_damage_flush(struct ssd1306_damage *damage,
+				  const uint8_t *frame, void *ssd1306);
+
+	/*
+	 * layers[0] is the bottom.  Everything starts dirty.  Fails for
+	 * frames taller than SSD1306_COMPOSITOR_MAX_PAGES pages.
+	 */
+	bool ssd1306_compositor_init(struct ssd1306_compositor *comp,
+				     uint8_t *frame,
+				     uint8_t width,
+				     uint8_t height,
+				     struct ssd1306_layer *layers,
+				     uint8_t count);
+
+	/* Marks a rectangle of the panel, in pixels, for recomposing */
+	void ssd1306_compositor_damage(struct ssd1306_compositor *comp,
+				       int16_t x, int16_t y,
+				       int16_t width, int16_t height);
+
+	/* Moves a layer, damaging where it was and where it goes */
+	void ssd1306_layer_move(struct ssd1306_compositor *comp,
+				struct ssd1306_layer *layer,
+				int16_t x, int16_t y);
+
+	void ssd1306_layer_show(struct ssd1306_compositor *comp,
+				struct ssd1306_layer *layer,
+				bool visible);
+
+	/* Call after changing a layer's pixels, mask or blend in place */
+	void ssd1306_layer_changed(struct ssd1306_compositor *comp,
+				   struct ssd1306_layer *layer);
+
+	/* Recomposes the dirty ranges into the frame */
+	void ssd1306_compositor_compose(struct ssd1306_compositor *comp);
+
+	/*
+	 * Composes, then sends exactly the dirty windows with
+	 * ssd1306_damage_flush().  ssd1306 is the driver object.
+	 */
+	bool ssd1306_compositor_flush(struct ssd1306_compositor *comp,
+				      void *ssd1306);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SSD1306_COMPOSITOR_H */
@@ -0,0 +1,68 @@
+#ifndef SSD1306_CONFIG_H
+#define SSD1306_CONFIG_H
+
+/*
+ * Compile-time feature selection.  Everything is on by default;
+ * define any of these to 0 (e.g. -DSSD1306_ENABLE_SCROLL=0) to leave
+ * that code out of the build.  tools/size_report.sh shows what each
+ * one costs.
+ */
+
+/* activate_scroll(), horizontal_scroll() and friends */
+#ifndef SSD1306_ENABLE_SCROLL
+#define SSD1306_ENABLE_SCROLL 1
+#endif
+
+/* fade() and zoom(), only present on datasheet v1.5 parts */
+#ifndef SSD1306_ENABLE_FADE_ZOOM
+#define SSD1306_ENABLE_FADE_ZOOM 1
+#endif
+
+/* The extern "C" wrappers in ssd1306_c.cpp */
+#ifndef SSD1306_ENABLE_C_API
+#define SSD1306_ENABLE_C_API 1
+#endif
+
+/* default_init().  Turn off if you send your own init sequence. */
+#ifndef SSD1306_ENABLE_DEFAULT_INIT
+#define SSD1306_ENABLE_DEFAULT_INIT 1
+#endif
+
+/* draw_bitmap() and its RLE decoder */
+#ifndef SSD1306_ENABLE_BITMAP
+#define SSD1306_ENABLE_BITMAP 1
+#endif
+
+/* set_read(), read() and the read-modify-write drawing path */
+#ifndef SSD1306_ENABLE_READ
+#define SSD1306_ENABLE_READ 1
+#endif
+
+/* Retry with backoff, page commit tracking and background refresh */
+#ifndef SSD1306_ENABLE_RECOVERY
+#define SSD1306_ENABLE_RECOVERY 1
+#endif
+
+/* orientation() and the 90/270 degree transpose in flush() */
+#ifndef SSD1306_ENABLE_ORIENTATION
+#define SSD1306_ENABLE_ORIENTATION 1
+#endif
+
+/* The layer compositor in ssd1306_compositor.cpp */
+#ifndef SSD1306_ENABLE_COMPOSITOR
+#define SSD1306_ENABLE_COMPOSITOR 1
+#endif
+
+/* The 8080/6800 parallel transport in ssd1306_parallel.cpp */
+#ifndef SSD1306_ENABLE_PARALLEL
+#define SSD1306_ENABLE_PARALLEL 1
+#endif
+
+/*
+ * Define to one ssd1306_screen_type (e.g. -DSSD1306_FIXED_SCREEN=ssd1306_128_32)
+ * to compile in only that geometry.  The type argument to default_init()
+ * is then ignored.
+ */
+/* #define SSD1306_FIXED_SCREEN ssd1306_128_32 */
+
+#endif /* SSD1306_CONFIG_H */
@@ -0,0 +1,186 @@
+#include "ssd1306.h"
+#include "ssd1306_commands.h"
+
+#if SSD1306_ENABLE_DEFAULT_INIT
+
+/*
+ * The SSD1306 sequence default_init() has always sent, as one table.
+ * Only the multiplex ratio, COM pins, contrast, charge pump and
+ * precharge differ between modules.
+ */
+#define SSD1306_INIT(mux, compins, contr, pump, prechg)			\
+	SSD1306_DISPLAYOFF,						\
+	SSD1306_SETMULTIPLEX, (mux),					\
+	SSD1306_SETDISPLAYOFFSET, 0x00,					\
+	SSD1306_SETSTARTLINE,						\
+	SSD1306_SEGREMAP | 0x01,					\
+	SSD1306_COMSCANDEC,						\
+	SSD1306_SETCOMPINS, (compins),					\
+	SSD1306_SETCONTRAST, (contr),					\
+	SSD1306_SETDISPLAYCLOCKDIV, 0x80,				\
+	SSD1306_CHARGEPUMP, (pump),					\
+	SSD1306_SETPRECHARGE, (prechg),					\
+	SSD1306_SETVCOMDESELECT, 0x40,					\
+	SSD1306_DISPLAYALLONRESUME,					\
+	SSD1306_NORMALDISPLAY,						\
+	SSD1306_DEACTIVATE_SCROLL,					\
+	SSD1306_FADE, SSD1306_DISABLE_FADE,				\
+	SSD1306_ZOOM, 0x00
+
+#define SSD1306_PUMP_OFF	0x10
+#define SSD1306_PUMP_ON		0x14
+
+#define INIT_TABLE(table) { (table), sizeof(table) }
+
+/* 128x32 */
+static constexpr uint8_t init_128_32_ext[] = {
+	SSD1306_INIT(31, 0x02, 0x8F, SSD1306_PUMP_OFF, 0x22)
+};
+static constexpr uint8_t init_128_32_pump[] = {
+	SSD1306_INIT(31, 0x02, 0x8F, SSD1306_PUMP_ON, 0xF1)
+};
+
+/* 128x64 */
+static constexpr uint8_t init_128_64_ext[] = {
+	SSD1306_INIT(63, 0x12, 0x9F, SSD1306_PUMP_OFF, 0x22)
+};
+static constexpr uint8_t init_128_64_pump[] = {
+	SSD1306_INIT(63, 0x12, 0xCF, SSD1306_PUMP_ON, 0xF1)
+};
+
+/* 96x16 */
+static constexpr uint8_t init_96_16_ext[] = {
+	SSD1306_INIT(15, 0x02, 0x10, SSD1306_PUMP_OFF, 0x22)
+};
+static constexpr uint8_t init_96_16_pump[] = {
+	SSD1306_INIT(15, 0x02, 0xAF, SSD1306_PUMP_ON, 0xF1)
+};
+
+/* 64x48, visible area starts at column 32 */
+static constexpr uint8_t init_64_48_ext[] = {
+	SSD1306_INIT(47, 0x12, 0x9F, SSD1306_PUMP_OFF, 0x22)
+};
+static constexpr uint8_t init_64_48_pump[] = {
+	SSD1306_INIT(47, 0x12, 0xCF, SSD1306_PUMP_ON, 0xF1)
+};
+
+/* 72x40, visible area starts at column 28, needs the internal IREF */
+static constexpr uint8_t init_72_40_ext[] = {
+	SSD1306_INIT(39, 0x12, 0x9F, SSD1306_PUMP_OFF, 0x22),
+	SSD1306_SETIREF, 0x30
+};
+static constexpr uint8_t init_72_40_pump[] = {
+	SSD1306_INIT(39, 0x12, 0xCF, SSD1306_PUMP_ON, 0xF1),
+	SSD1306_SETIREF, 0x30
+};
+
+/*
+ * SH1106: 132-column RAM with the panel at column 2, page addressing
+ * only, and a DC-DC converter instead of the charge pump.  It has no
+ * scroll, fade or zoom commands.
+ */
+#define SH1106_INIT(dcdc, prechg)					\
+	SSD1306_DISPLAYOFF,						\
+	SSD1306_SETDISPLAYCLOCKDIV, 0x80,				\
+	SSD1306_SETMULTIPLEX, 63,					\
+	SSD1306_SETDISPLAYOFFSET, 0x00,					\
+	SSD1306_SETSTARTLINE,						\
+	SH1106_SETDCDC, (dcdc),						\
+	SSD1306_SEGREMAP | 0x01,					\
+	SSD1306_COMSCANDEC,						\
+	SSD1306_SETCOMPINS, 0x12,					\
+	SSD1306_SETCONTRAST, 0x80,					\
+	SSD1306_SETPRECHARGE, (prechg),					\
+	SSD1306_SETVCOMDESELECT, 0x40,					\
+	SSD1306_DISPLAYALLONRESUME,					\
+	SSD1306_NORMALDISPLAY
+
+static constexpr uint8_t init_sh1106_ext[] = {
+	SH1106_INIT(0x8A, 0x22)
+};
+static constexpr uint8_t init_sh1106_pump[] = {
+	SH1106_INIT(0x8B, 0x1F)
+};
+
+/*
+ * SSD1309: same addressing as the SSD1306 but no charge pump, so the
+ * panel always runs from external VCC and both entries are the same.
+ */
+static constexpr uint8_t init_ssd1309[] = {
+	SSD1306_DISPLAYOFF,
+	SSD1306_SETDISPLAYCLOCKDIV, 0xA0,
+	SSD1306_SETMULTIPLEX, 63,
+	SSD1306_SETDISPLAYOFFSET, 0x00,
+	SSD1306_SETSTARTLINE,
+	SSD1306_SEGREMAP | 0x01,
+	SSD1306_COMSCANDEC,
+	SSD1306_SETCOMPINS, 0x12,
+	SSD1306_SETCONTRAST, 0xDF,
+	SSD1306_SETPRECHARGE, 0x82,
+	SSD1306_SETVCOMDESELECT, 0x34,
+	SSD1306_DISPLAYALLONRESUME,
+	SSD1306_NORMALDISPLAY,
+	SSD1306_DEACTIVATE_SCROLL
+};
+
+static constexpr struct ssd1306_panel panel_128_32 = {
+	128, 32, 128, 0, SSD1306_MODES_ALL,
+	{ INIT_TABLE(init_128_32_ext), INIT_TABLE(init_128_32_pump) }
+};
+
+static constexpr struct ssd1306_panel panel_128_64 = {
+	128, 64, 128, 0, SSD1306_MODES_ALL,
+	{ INIT_TABLE(init_128_64_ext), INIT_TABLE(init_128_64_pump) }
+};
+
+static constexpr struct ssd1306_panel panel_96_16 = {
+	96, 16, 128, 0, SSD1306_MODES_ALL,
+	{ INIT_TABLE(init_96_16_ext), INIT_TABLE(init_96_16_pump) }
+};
+
+static constexpr struct ssd1306_panel panel_64_48 = {
+	64, 48, 128, 32, SSD1306_MODES_ALL,
+	{ INIT_TABLE(init_64_48_ext), INIT_TABLE(init_64_48_pump) }
+};
+
+static constexpr struct ssd1306_panel panel_72_40 = {
+	72, 40, 128, 28, SSD1306_MODES_ALL,
+	{ INIT_TABLE(init_72_40_ext), INIT_TABLE(init_72_40_pump) }
+};
+
+static constexpr struct ssd1306_panel panel_sh1106_128_64 = {
+	128, 64, 132, 2, SSD1306_MODE_BIT(ssd1306_page_a),
+	{ INIT_TABLE(init_sh1106_ext), INIT_TABLE(init_sh1106_pump) }
+};
+
+static constexpr struct ssd1306_panel panel_ssd1309_128_64 = {
+	128, 64, 128, 0, SSD1306_MODES_ALL,
+	{ INIT_TABLE(init_ssd1309), INIT_TABLE(init_ssd1309) }
+};
+
+const struct ssd1306_panel *ssd1306_panel_for(enum ssd1306_screen_type type)
+{
+#ifdef SSD1306_FIXED_SCREEN
+	/* Leaves every other table unreferenced, so the linker drops them */
+	type = SSD1306_FIXED_SCREEN;
+#endif
+	switch (type) {
+		case ssd1306_128_32:
+			return &panel_128_32;
+		case ssd1306_128_64:
+			return &panel_128_64;
+		case ssd1306_96_16:
+			return &panel_96_16;
+		case ssd1306_64_48:
+			return &panel_64_48;
+		case ssd1306_72_40:
+			return &panel_72_40;
+		case sh1106_128_64:
+			return &panel_sh1106_128_64;
+		case ssd1309_128_64:
+			return &panel_ssd1309_128_64;
+	}
+	return nullptr;
+}
+
+#endif /* SSD1306_ENABLE_DEFAULT_INIT */
@@ -0,0 +1,36 @@
+#ifndef SSD1306_PANEL_H
+#define SSD1306_PANEL_H
+#include <stdint.h>
+#include <stddef.h>
+
+/* Bits for ssd1306_panel.addr_modes */
+#define SSD1306_MODE_BIT(mode)	(1 << (mode))
+#define SSD1306_MODES_ALL	0x07
+
+/* A complete command sequence, sent as one transfer */
+struct ssd1306_init_table {
+	const uint8_t *cmds;
+	uint8_t size;
+};
+
+/*
+ * Everything the driver needs to know about a module.  width and height
+ * are the visible area, ram_width the controller's GDDRAM width, and
+ * column_offset where the visible area starts in it.  init is indexed
+ * by ssd1306_vccstate and leaves the display off; the driver sets the
+ * addressing mode (when the part has more than one) and turns it on.
+ *
+ * Parts whose addr_modes include horizontal mode are flushed with a
+ * single window and burst, page-only parts (SH1106) with one cursor
+ * command and burst per page.
+ */
+struct ssd1306_panel {
+	uint8_t width;
+	uint8_t height;
+	uint8_t ram_width;
+	uint8_t column_offset;
+	uint8_t addr_modes;
+	struct ssd1306_init_table init[2];
+};
+
+#endif /* SSD1306_PANEL_H */
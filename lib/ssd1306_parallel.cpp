@@ -0,0 +1,160 @@
+#include "ssd1306_parallel.h"
+
+#if SSD1306_ENABLE_PARALLEL
+
+const struct ssd1306_parallel_timing ssd1306_8080_timing = {
+	300,	/* cycle */
+	10,	/* addr_setup */
+	40,	/* data_setup */
+	7,	/* data_hold */
+	140,	/* access */
+	60,	/* strobe_active (tPWLW) */
+	60,	/* strobe_idle (tPWHW) */
+	150,	/* read_active (tPWLR) */
+	60	/* read_idle (tPWHR) */
+};
+
+const struct ssd1306_parallel_timing ssd1306_6800_timing = {
+	300,	/* cycle */
+	0,	/* addr_setup */
+	40,	/* data_setup */
+	7,	/* data_hold */
+	140,	/* access */
+	60,	/* strobe_active (PWCSL write) */
+	60,	/* strobe_idle (PWCSH write) */
+	120,	/* read_active (PWCSL read) */
+	60	/* read_idle (PWCSH read) */
+};
+
+static inline uint16_t max_ns(uint16_t a, uint16_t b)
+{
+	return a > b ? a : b;
+}
+
+/*
+ * Data goes on the port before the strobe becomes active, so holding it
+ * active for data_setup covers the setup time to the latching edge.
+ */
+static inline uint16_t write_active_ns(const struct ssd1306_parallel_timing *t)
+{
+	return max_ns(t->strobe_active, t->data_setup);
+}
+
+static inline uint16_t write_idle_ns(const struct ssd1306_parallel_timing *t)
+{
+	uint16_t active = write_active_ns(t);
+	uint16_t rest = t->cycle > active ? t->cycle - active : 0;
+	return max_ns(max_ns(t->strobe_idle, t->data_hold), rest);
+}
+
+static inline void wait(const struct ssd1306_parallel *bus, uint16_t ns)
+{
+	if (ns && bus->ops->delay_ns)
+		bus->ops->delay_ns(bus->port, ns);
+}
+
+/* The level that makes the strobe active: WR# low, or E high */
+static inline bool strobe_on(const struct ssd1306_parallel *bus)
+{
+	return bus->bus == ssd1306_bus_6800;
+}
+
+void ssd1306_parallel_init(struct ssd1306_parallel *bus)
+{
+	const struct ssd1306_gpio_ops *ops = bus->ops;
+
+	ops->pin(bus->port, ssd1306_pin_cs, 1);
+	if (bus->bus == ssd1306_bus_8080) {
+		ops->pin(bus->port, ssd1306_pin_wr, 1);
+		ops->pin(bus->port, ssd1306_pin_rd, 1);
+	} else {
+		ops->pin(bus->port, ssd1306_pin_wr, 0);
+		ops->pin(bus->port, ssd1306_pin_rd, 0);
+	}
+	if (ops->port_dir)
+		ops->port_dir(bus->port, 1);
+}
+
+/*
+ * CS and D/C are set once per call, so a full-frame draw() is a single
+ * tight strobe loop with the delays worked out up front.  The bus has
+ * no acknowledge, so this can't fail.
+ */
+bool ssd1306_parallel_write(void *conn_info, const uint8_t *buffer,
+			    size_t size, bool is_cmd)
+{
+	const struct ssd1306_parallel *bus = (const struct ssd1306_parallel *)conn_info;
+	const struct ssd1306_gpio_ops *ops = bus->ops;
+	void *port = bus->port;
+	/* The pin that strobes data in: WR# on 8080, E on 6800 */
+	const enum ssd1306_pin strobe = strobe_on(bus) ? ssd1306_pin_rd
+						       : ssd1306_pin_wr;
+	const bool active = strobe_on(bus);
+	const uint16_t active_ns = write_active_ns(bus->timing);
+	const uint16_t idle_ns = write_idle_ns(bus->timing);
+
+	ops->pin(port, ssd1306_pin_dc, !is_cmd);
+	ops->pin(port, ssd1306_pin_cs, 0);
+	wait(bus, bus->timing->addr_setup);
+
+	if (ops->write_burst) {
+		ops->write_burst(port, bus->bus, buffer, size);
+	} else {
+		for (size_t i = 0; i < size; i++) {
+			ops->port_write(port, buffer[i]);
+			ops->pin(port, strobe, active);
+			wait(bus, active_ns);
+			ops->pin(port, strobe, !active);
+			wait(bus, idle_ns);
+		}
+	}
+
+	ops->pin(port, ssd1306_pin_cs, 1);
+	return true;
+}
+
+bool ssd1306_parallel_read(void *conn_info, uint8_t *buffer, size_t size)
+{
+	const struct ssd1306_parallel *bus = (const struct ssd1306_parallel *)conn_info;
+	const struct ssd1306_gpio_ops *ops = bus->ops;
+	const struct ssd1306_parallel_timing *t = bus->timing;
+	void *port = bus->port;
+	const bool active = strobe_on(bus);
+	const uint16_t active_ns = max_ns(t->read_active, t->access);
+	const uint16_t idle_ns = t->cycle > active_ns ?
+				 max_ns(t->read_idle, t->cycle - active_ns) :
+				 t->read_idle;
+
+	if (!ops->port_read || !ops->port_dir)
+		return false;
+
+	ops->port_dir(port, 0);
+	ops->pin(port, ssd1306_pin_dc, 1);
+	if (bus->bus == ssd1306_bus_6800)
+		ops->pin(port, ssd1306_pin_wr, 1);
+	ops->pin(port, ssd1306_pin_cs, 0);
+	wait(bus, t->addr_setup);
+
+	for (size_t i = 0; i < size; i++) {
+		ops->pin(port, ssd1306_pin_rd, active);
+		wait(bus, active_ns);
+		buffer[i] = ops->port_read(port);
+		ops->pin(port, ssd1306_pin_rd, !active);
+		wait(bus, idle_ns);
+	}
+
+	ops->pin(port, ssd1306_pin_cs, 1);
+	if (bus->bus == ssd1306_bus_6800)
+		ops->pin(port, ssd1306_pin_wr, 0);
+	ops->port_dir(port, 1);
+	return true;
+}
+
+uint32_t ssd1306_parallel_burst_ns(const struct ssd1306_parallel *bus,
+				   size_t size)
+{
+	const struct ssd1306_parallel_timing *t = bus->timing;
+	return t->addr_setup + (uint32_t)size * (write_active_ns(t) + write_idle_ns(t));
+}
+
+#endif /* SSD1306_ENABLE_PARALLEL */
@@ -0,0 +1,105 @@
+#ifndef SSD1306_PARALLEL_H
+#define SSD1306_PARALLEL_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "ssd1306_config.h"
+
+/*
+ * A ready-made transport for the 8080 and 6800 parallel interfaces,
+ * written against a small GPIO abstraction.  Fill in an ssd1306_parallel
+ * and pass ssd1306_parallel_write / ssd1306_parallel_read to the driver
+ * with a pointer to it as the connection info.
+ */
+
+enum ssd1306_bus {
+	ssd1306_bus_8080,
+	ssd1306_bus_6800
+};
+
+/*
+ * The control lines.  On a 6800 bus WR is R/W# and RD is E.
+ */
+enum ssd1306_pin {
+	ssd1306_pin_cs,
+	ssd1306_pin_dc,
+	ssd1306_pin_wr,
+	ssd1306_pin_rd
+};
+
+/*
+ * Platform GPIO hooks.  port is the user pointer from ssd1306_parallel.
+ * port_read, port_dir and delay_ns may be NULL: without the first two
+ * reads are unavailable, and without delay_ns the GPIO calls themselves
+ * must be slow enough to meet the timing.
+ *
+ * write_burst is an optional fast path: it gets CS and D/C already set
+ * and must put each byte on D0-D7 and strobe it in.  Provide it when
+ * per-pin calls through function pointers are too slow for full frames.
+ */
+struct ssd1306_gpio_ops {
+	void (*port_write)(void *port, uint8_t value);
+	uint8_t (*port_read)(void *port);
+	void (*port_dir)(void *port, bool output);
+	void (*pin)(void *port, enum ssd1306_pin pin, bool level);
+	void (*delay_ns)(void *port, uint16_t ns);
+	void (*write_burst)(void *port, enum ssd1306_bus bus,
+			    const uint8_t *buffer, size_t size);
+};
+
+/*
+ * Bus timing in nanoseconds, from the AC characteristics tables.
+ * strobe_active is how long WR# is low (8080) or E is high (6800) on a
+ * write, read_active the same on a read.
+ */
+struct ssd1306_parallel_timing {
+	uint16_t cycle;
+	uint16_t addr_setup;
+	uint16_t data_setup;
+	uint16_t data_hold;
+	uint16_t access;
+	uint16_t strobe_active;
+	uint16_t strobe_idle;
+	uint16_t read_active;
+	uint16_t read_idle;
+};
+
+struct ssd1306_parallel {
+	enum ssd1306_bus bus;
+	const struct ssd1306_gpio_ops *ops;
+	void *port;
+	const struct ssd1306_parallel_timing *timing;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if SSD1306_ENABLE_PARALLEL
+	/* Minimums from the SSD1306 datasheet, VDD 1.65-3.3V */
+	extern const struct ssd1306_parallel_timing ssd1306_8080_timing;
+	extern const struct ssd1306_parallel_timing ssd1306_6800_timing;
+
+	/* Puts the control lines in their idle state */
+	void ssd1306_parallel_init(struct ssd1306_parallel *bus);
+
+	bool ssd1306_parallel_write(void *conn_info,
+				    const uint8_t *buffer,
+				    size_t size,
+				    bool is_cmd);
+
+	/* Fails if the GPIO ops can't turn the port around or read it */
+	bool ssd1306_parallel_read(void *conn_info, uint8_t *buffer, size_t size);
+
+	/*
+	 * The time a burst of size bytes takes on the bus according to the
+	 * timing model, ignoring GPIO call overhead.
+	 */
+	uint32_t ssd1306_parallel_burst_ns(const struct ssd1306_parallel *bus,
+					   size_t size);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SSD1306_PARALLEL_H */
@@ -0,0 +1,119 @@
+#!/bin/sh
+#
+# Prints text/data/bss of the library for each toolchain with every
+# feature on, with every feature off, and with each feature turned off
+# on its own.  The "cost" column is what that feature adds to the full
+# build.
+#
+# usage: tools/size_report.sh [-o sizes.txt] [-b baseline.txt]
+#
+#   -o FILE  also write the raw numbers to FILE
+#   -b FILE  compare against numbers saved with -o earlier and exit
+#            non-zero if any section grew
+#
+# Toolchains are taken from the environment, and skipped if missing:
+#   HOST_CXX (c++), HOST_SIZE (size)
+#   ARM_CXX (arm-none-eabi-g++), ARM_SIZE (arm-none-eabi-size),
+#   ARM_FLAGS (-mcpu=cortex-m3 -mthumb)
+
+set -e
+
+LIB=$(cd "$(dirname "$0")/../lib" && pwd)
+CXXFLAGS="-std=c++11 -Os -ffunction-sections -fdata-sections -fno-exceptions -fno-rtti"
+
+# Keep in step with lib/ssd1306_config.h
+FEATURES="SCROLL FADE_ZOOM C_API DEFAULT_INIT BITMAP READ PARALLEL RECOVERY COMPOSITOR ORIENTATION"
+
+OUT=
+BASELINE=
+while getopts "o:b:" opt; do
+	case $opt in
+	o) OUT=$OPTARG ;;
+	b) BASELINE=$OPTARG ;;
+	*) sed -n '8,13p' "$0"; exit 2 ;;
+	esac
+done
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+: > "$TMP/sizes"
+
+# measure <toolchain> <cxx> <size> <config> <flags...>
+measure()
+{
+	name=$1 cxx=$2 size=$3 config=$4
+	shift 4
+	objs=
+	for src in "$LIB"/*.cpp; do
+		obj="$TMP/$(basename "$src" .cpp).o"
+		# shellcheck disable=SC2086
+		$cxx $CXXFLAGS "$@" -I"$LIB" -c "$src" -o "$obj"
+		objs="$objs $obj"
+	done
+	# shellcheck disable=SC2086
+	$size -t $objs | tail -n 1 |
+		awk -v t="$name" -v c="$config" '{ print t, c, $1, $2, $3 }' \
+		>> "$TMP/sizes"
+	rm -f $objs
+}
+
+# report <toolchain> <cxx> <size> [extra flags]
+report()
+{
+	name=$1 cxx=$2 size=$3 extra=$4
+	if ! command -v "$cxx" >/dev/null 2>&1; then
+		echo "skipping $name: $cxx not found" >&2
+		return
+	fi
+
+	all_off=
+	for f in $FEATURES; do
+		all_off="$all_off -DSSD1306_ENABLE_$f=0"
+	done
+
+	# shellcheck disable=SC2086
+	measure "$name" "$cxx" "$size" full $extra
+	# shellcheck disable=SC2086
+	measure "$name" "$cxx" "$size" minimal $extra $all_off
+	# shellcheck disable=SC2086
+	measure "$name" "$cxx" "$size" fixed_screen $extra \
+		-DSSD1306_FIXED_SCREEN=ssd1306_128_32
+	for f in $FEATURES; do
+		# shellcheck disable=SC2086
+		measure "$name" "$cxx" "$size" "no_$(echo $f | tr 'A-Z' 'a-z')" \
+			$extra -DSSD1306_ENABLE_$f=0
+	done
+}
+
+report host "${HOST_CXX:-c++}" "${HOST_SIZE:-size}"
+report arm "${ARM_CXX:-arm-none-eabi-g++}" "${ARM_SIZE:-arm-none-eabi-size}" \
+	"${ARM_FLAGS:--mcpu=cortex-m3 -mthumb}"
+
+awk '
+	$2 == "full" { full[$1] = $3 + $4 + $5 }
+	{ rows[NR] = $0 }
+	END {
+		printf "%-6s %-18s %7s %7s %7s %7s\n", "chain", "config", "text", "data", "bss", "cost"
+		for (i = 1; i <= NR; i++) {
+			split(rows[i], r, " ")
+			cost = ""
+			if (r[2] != "full")
+				cost = full[r[1]] - (r[3] + r[4] + r[5])
+			printf "%-6s %-18s %7d %7d %7d %7s\n", r[1], r[2], r[3], r[4], r[5], cost
+		}
+	}' "$TMP/sizes"
+
+[ -n "$OUT" ] && cp "$TMP/sizes" "$OUT"
+
+if [ -n "$BASELINE" ]; then
+	awk '
+		NR == FNR { base[$1 " " $2] = $0; next }
+		($1 " " $2) in base {
+			split(base[$1 " " $2], b, " ")
+			if ($3 > b[3] || $4 > b[4] || $5 > b[5]) {
+				printf "size regression: %s %s %d/%d/%d -> %d/%d/%d\n", $1, $2, b[3], b[4], b[5], $3, $4, $5
+				grew = 1
+			}
+		}
+		END { exit grew }' "$BASELINE" "$TMP/sizes"
+fi
@@ -0,0 +1,517 @@
+/*
+ * ssd1306_assets: converts PBM/PGM images and BDF fonts into headers
+ * holding page-major arrays, ready to be sent by SSD1306::draw() or
+ * SSD1306::draw_bitmap() straight from flash.
+ *
+ * This is a host tool, built with the host compiler:
+ *	c++ -std=c++11 -O2 -o ssd1306_assets tools/ssd1306_assets.cpp
+ *
+ * Run ./ssd1306_assets -h for usage.  See README.md for build integration.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+
+/* Keep these in step with lib/ssd1306_asset.h */
+static const int RLE_RUN = 0x80;
+static const int RLE_MIN_RUN = 2;
+static const int RLE_MAX_RUN = 0x7F + RLE_MIN_RUN;
+static const int RLE_MAX_LITERAL = 0x80;
+
+struct image {
+	int width = 0;
+	int height = 0;
+	std::vector<uint8_t> lit;	/* one entry per pixel, row-major */
+
+	bool at(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= width || y >= height)
+			return false;
+		return lit[(size_t)y * width + x];
+	}
+};
+
+struct options {
+	std::string input;
+	std::string output;
+	std::string name;
+	std::string depfile;
+	int screen_width = 0;
+	int screen_height = 0;
+	int threshold = -1;
+	int first = 32;
+	int last = 126;
+	bool compress = false;
+	bool invert = false;
+};
+
+static void die(const char *fmt, const std::string &arg = "")
+{
+	fprintf(stderr, "ssd1306_assets: ");
+	fprintf(stderr, fmt, arg.c_str());
+	fprintf(stderr, "\n");
+	exit(1);
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: ssd1306_assets [options] -o out.h input.{pbm,pgm,bdf}\n"
+		"  -o FILE    header to write (left untouched if unchanged)\n"
+		"  -n NAME    C identifier for the asset (default: from input)\n"
+		"  -s WxH     crop/pad image to a screen type: 128x32, 128x64, 96x16,\n"
+		"             64x48, 72x40\n"
+		"  -c         RLE-compress the image (use draw_bitmap())\n"
+		"  -t N       PGM threshold, pixels above N are lit (default: maxval/2)\n"
+		"  -i         invert pixels\n"
+		"  -r A-B     font character range, at most 255 glyphs (default: 32-126)\n"
+		"  -M FILE    write a make-style dependency file\n");
+	exit(2);
+}
+
+/*
+ * Netpbm allows comments anywhere whitespace is allowed in the header.
+ */
+static int read_header_int(FILE *f)
+{
+	int c = fgetc(f);
+	while (c != EOF) {
+		if (c == '#') {
+			while (c != EOF && c != '\n')
+				c = fgetc(f);
+		} else if (!isspace(c)) {
+			break;
+		}
+		c = fgetc(f);
+	}
+	if (c == EOF || !isdigit(c))
+		die("malformed netpbm header");
+
+	int value = 0;
+	while (c != EOF && isdigit(c)) {
+		value = value * 10 + (c - '0');
+		c = fgetc(f);
+	}
+	/* Exactly one whitespace byte separates the header from raster data */
+	return value;
+}
+
+static image read_netpbm(const std::string &path, int threshold, bool invert)
+{
+	FILE *f = fopen(path.c_str(), "rb");
+	if (!f)
+		die("cannot open %s", path);
+
+	char magic[2];
+	if (fread(magic, 1, 2, f) != 2 || magic[0] != 'P')
+		die("%s is not a PBM/PGM file", path);
+
+	int kind = magic[1] - '0';
+	if (kind != 1 && kind != 2 && kind != 4 && kind != 5)
+		die("%s: only P1, P2, P4 and P5 are supported", path);
+
+	image img;
+	img.width = read_header_int(f);
+	img.height = read_header_int(f);
+	if (img.width <= 0 || img.height <= 0)
+		die("%s: bad dimensions", path);
+
+	int maxval = 1;
+	if (kind == 2 || kind == 5) {
+		maxval = read_header_int(f);
+		if (maxval <= 0 || maxval > 65535)
+			die("%s: bad maxval", path);
+	}
+	if (threshold < 0)
+		threshold = maxval / 2;
+
+	img.lit.resize((size_t)img.width * img.height);
+	int byte = 0;
+
+	for (int y = 0; y < img.height; y++) {
+		for (int x = 0; x < img.width; x++) {
+			bool on = false;
+			int c;
+
+			switch (kind) {
+			case 1:
+				/* PBM: 1 is ink, which we light up */
+				do {
+					c = fgetc(f);
+				} while (c != EOF && c != '0' && c != '1');
+				if (c == EOF)
+					die("%s: truncated", path);
+				on = c == '1';
+				break;
+			case 4:
+				/* Rows are padded to a whole byte */
+				if (x % 8 == 0 && (byte = fgetc(f)) == EOF)
+					die("%s: truncated", path);
+				on = byte & (0x80 >> (x % 8));
+				break;
+			case 2:
+				on = read_header_int(f) > threshold;
+				break;
+			case 5: {
+				int v = fgetc(f);
+				if (maxval > 255)
+					v = (v << 8) | fgetc(f);
+				if (v < 0)
+					die("%s: truncated", path);
+				on = v > threshold;
+				break;
+			}
+			}
+			img.lit[(size_t)y * img.width + x] = on != invert;
+		}
+	}
+	fclose(f);
+	return img;
+}
+
+/*
+ * Reads the glyphs first..last of a BDF font, each rendered into a cell
+ * the size of FONTBOUNDINGBOX.  Missing glyphs are left blank.
+ */
+static std::vector<image> read_bdf(const std::string &path, int first, int last,
+				   bool invert)
+{
+	std::ifstream in(path);
+	if (!in)
+		die("cannot open %s", path);
+
+	int cell_w = 0, cell_h = 0, cell_x = 0, cell_y = 0;
+	std::vector<image> glyphs(last - first + 1);
+	std::string line;
+
+	int encoding = -1;
+	int bbx_w = 0, bbx_h = 0, bbx_x = 0, bbx_y = 0;
+
+	while (std::getline(in, line)) {
+		std::istringstream ls(line);
+		std::string key;
+		ls >> key;
+
+		if (key == "FONTBOUNDINGBOX") {
+			ls >> cell_w >> cell_h >> cell_x >> cell_y;
+			for (auto &g : glyphs) {
+				g.width = cell_w;
+				g.height = cell_h;
+				g.lit.assign((size_t)cell_w * cell_h, invert);
+			}
+		} else if (key == "ENCODING") {
+			ls >> encoding;
+		} else if (key == "BBX") {
+			ls >> bbx_w >> bbx_h >> bbx_x >> bbx_y;
+		} else if (key == "BITMAP") {
+			if (!cell_w)
+				die("%s: BITMAP before FONTBOUNDINGBOX", path);
+			bool wanted = encoding >= first && encoding <= last;
+			/* Row 0 of the glyph sits this far below the cell top */
+			int top = (cell_h + cell_y) - (bbx_y + bbx_h);
+			int left = bbx_x - cell_x;
+
+			for (int row = 0; row < bbx_h; row++) {
+				if (!std::getline(in, line))
+					die("%s: truncated BITMAP", path);
+				if (!wanted)
+					continue;
+
+				image &g = glyphs[encoding - first];
+				for (int col = 0; col < bbx_w; col++) {
+					size_t nibble = col / 4;
+					if (nibble >= line.size())
+						break;
+					int bits = (int)strtol(line.substr(nibble, 1).c_str(),
+							       NULL, 16);
+					if (!(bits & (0x8 >> (col % 4))))
+						continue;
+					int x = left + col;
+					int y = top + row;
+					if (x >= 0 && y >= 0 && x < cell_w && y < cell_h)
+						g.lit[(size_t)y * cell_w + x] = !invert;
+				}
+			}
+		} else if (key == "ENDCHAR") {
+			encoding = -1;
+		}
+	}
+	if (!cell_w)
+		die("%s: no FONTBOUNDINGBOX", path);
+	return glyphs;
+}
+
+/*
+ * Lays the image out the way GDDRAM holds it in horizontal addressing
+ * mode: page by page, one byte per column, bit 0 at the top.
+ */
+static std::vector<uint8_t> to_pages(const image &img, int width, int height)
+{
+	int pages = (height + 7) / 8;
+	std::vector<uint8_t> out;
+	out.reserve((size_t)width * pages);
+
+	for (int page = 0; page < pages; page++) {
+		for (int x = 0; x < width; x++) {
+			uint8_t byte = 0;
+			for (int bit = 0; bit < 8; bit++) {
+				int y = page * 8 + bit;
+				if (y < height && img.at(x, y))
+					byte |= 1 << bit;
+			}
+			out.push_back(byte);
+		}
+	}
+	return out;
+}
+
+static std::vector<uint8_t> rle_encode(const std::vector<uint8_t> &in)
+{
+	std::vector<uint8_t> out;
+	size_t i = 0;
+
+	while (i < in.size()) {
+		size_t run = 1;
+		while (i + run < in.size() && in[i + run] == in[i] &&
+		       run < (size_t)RLE_MAX_RUN)
+			run++;
+
+		if (run >= (size_t)RLE_MIN_RUN) {
+			out.push_back((uint8_t)(RLE_RUN + run - RLE_MIN_RUN));
+			out.push_back(in[i]);
+			i += run;
+			continue;
+		}
+
+		/* Gather literals up to the next run worth encoding */
+		size_t start = i;
+		while (i < in.size() && i - start < (size_t)RLE_MAX_LITERAL) {
+			if (i + 1 < in.size() && in[i + 1] == in[i])
+				break;
+			i++;
+		}
+		out.push_back((uint8_t)(i - start - 1));
+		out.insert(out.end(), in.begin() + start, in.begin() + i);
+	}
+	return out;
+}
+
+static void emit_array(std::ostringstream &os, const std::string &name,
+		       const std::vector<uint8_t> &bytes)
+{
+	os << "SSD1306_ASSET uint8_t " << name << "[] = {";
+	for (size_t i = 0; i < bytes.size(); i++) {
+		if (i % 12 == 0)
+			os << "\n\t";
+		char hex[8];
+		snprintf(hex, sizeof(hex), "0x%02X,", bytes[i]);
+		os << hex << (i % 12 == 11 || i + 1 == bytes.size() ? "" : " ");
+	}
+	os << "\n};\n\n";
+}
+
+static std::string identifier_from(const std::string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	std::string base = path.substr(slash == std::string::npos ? 0 : slash + 1);
+	base = base.substr(0, base.find('.'));
+
+	std::string id;
+	for (char c : base)
+		id += isalnum((unsigned char)c) ? (char)tolower(c) : '_';
+	if (id.empty() || isdigit((unsigned char)id[0]))
+		id = "_" + id;
+	return id;
+}
+
+static std::string upper(std::string s)
+{
+	for (char &c : s)
+		c = (char)toupper((unsigned char)c);
+	return s;
+}
+
+static bool ends_with(const std::string &s, const std::string &suffix)
+{
+	return s.size() >= suffix.size() &&
+	       s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/*
+ * Only touch the output when its contents change, so regenerating
+ * assets doesn't force everything that includes them to rebuild.
+ */
+static void write_if_changed(const std::string &path, const std::string &text)
+{
+	std::ifstream old(path, std::ios::binary);
+	if (old) {
+		std::ostringstream cur;
+		cur << old.rdbuf();
+		if (cur.str() == text)
+			return;
+	}
+	std::ofstream out(path, std::ios::binary);
+	if (!(out << text))
+		die("cannot write %s", path);
+}
+
+static void write_depfile(const options &opt)
+{
+	std::ofstream out(opt.depfile);
+	if (!(out << opt.output << ": " << opt.input << "\n" << opt.input << ":\n"))
+		die("cannot write %s", opt.depfile);
+}
+
+static options parse_args(int argc, char **argv)
+{
+	options opt;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		auto value = [&]() -> std::string {
+			if (++i >= argc)
+				usage();
+			return argv[i];
+		};
+
+		if (arg == "-o") {
+			opt.output = value();
+		} else if (arg == "-n") {
+			opt.name = value();
+		} else if (arg == "-s") {
+			/* The geometries of ssd1306_screen_type */
+			static const struct { const char *name; int w, h; } screens[] = {
+				{ "128x32", 128, 32 }, { "128x64", 128, 64 },
+				{ "96x16", 96, 16 }, { "64x48", 64, 48 },
+				{ "72x40", 72, 40 },
+			};
+			std::string s = value();
+			opt.screen_width = 0;
+			for (const auto &screen : screens) {
+				if (s == screen.name) {
+					opt.screen_width = screen.w;
+					opt.screen_height = screen.h;
+				}
+			}
+			if (!opt.screen_width)
+				die("unknown screen type %s", s);
+		} else if (arg == "-c") {
+			opt.compress = true;
+		} else if (arg == "-t") {
+			opt.threshold = atoi(value().c_str());
+		} else if (arg == "-i") {
+			opt.invert = true;
+		} else if (arg == "-r") {
+			std::string r = value();
+			if (sscanf(r.c_str(), "%d-%d", &opt.first, &opt.last) != 2 ||
+			    opt.first < 0 || opt.last > 255 || opt.first > opt.last)
+				die("bad character range %s", r);
+			/* ssd1306_font.count is a uint8_t */
+			if (opt.last - opt.first + 1 > 255)
+				die("character range %s has more than 255 glyphs", r);
+		} else if (arg == "-M") {
+			opt.depfile = value();
+		} else if (arg[0] == '-' || !opt.input.empty()) {
+			usage();
+		} else {
+			opt.input = arg;
+		}
+	}
+	if (opt.input.empty() || opt.output.empty())
+		usage();
+	if (opt.name.empty())
+		opt.name = identifier_from(opt.input);
+	return opt;
+}
+
+static std::string header_open(const options &opt)
+{
+	std::ostringstream os;
+	std::string guard = "SSD1306_ASSET_" + upper(opt.name) + "_H";
+	std::string base = opt.input.substr(opt.input.find_last_of("/\\") + 1);
+
+	os << "/* Generated by ssd1306_assets from " << base
+	   << ". Do not edit. */\n"
+	   << "#ifndef " << guard << "\n"
+	   << "#define " << guard << "\n"
+	   << "#include \"ssd1306_asset.h\"\n\n";
+	return os.str();
+}
+
+static std::string bitmap_header(const options &opt)
+{
+	image img = read_netpbm(opt.input, opt.threshold, opt.invert);
+	int width = opt.screen_width ? opt.screen_width : img.width;
+	int height = opt.screen_height ? opt.screen_height : img.height;
+	if (width > 0xFFFF || height > 0xFF)
+		die("%s is too large for a bitmap", opt.input);
+
+	std::vector<uint8_t> bytes = to_pages(img, width, height);
+	if (opt.compress)
+		bytes = rle_encode(bytes);
+	if (bytes.size() > 0xFFFF)
+		die("%s is too large for a bitmap", opt.input);
+
+	std::ostringstream os;
+	os << header_open(opt);
+	emit_array(os, opt.name + "_data", bytes);
+	os << "SSD1306_ASSET struct ssd1306_bitmap " << opt.name << " = {\n\t"
+	   << width << ", " << height << ", " << (height + 7) / 8 << ", "
+	   << (opt.compress ? "true" : "false") << ", "
+	   << "sizeof(" << opt.name << "_data), " << opt.name << "_data\n};\n\n"
+	   << "#endif\n";
+	return os.str();
+}
+
+static std::string font_header(const options &opt)
+{
+	if (opt.compress)
+		die("fonts need random access and cannot be compressed");
+
+	std::vector<image> glyphs = read_bdf(opt.input, opt.first, opt.last,
+					     opt.invert);
+	int width = glyphs[0].width;
+	int height = glyphs[0].height;
+	if (width > 0xFF || height > 0xFF)
+		die("%s has glyphs that are too large", opt.input);
+
+	std::vector<uint8_t> bytes;
+	for (const image &g : glyphs) {
+		std::vector<uint8_t> pages = to_pages(g, width, height);
+		bytes.insert(bytes.end(), pages.begin(), pages.end());
+	}
+
+	std::ostringstream os;
+	os << header_open(opt);
+	emit_array(os, opt.name + "_data", bytes);
+	os << "SSD1306_ASSET struct ssd1306_font " << opt.name << " = {\n\t"
+	   << opt.first << ", " << glyphs.size() << ", " << width << ", "
+	   << height << ", " << (height + 7) / 8 << ", " << opt.name
+	   << "_data\n};\n\n"
+	   << "#endif\n";
+	return os.str();
+}
+
+int main(int argc, char **argv)
+{
+	options opt = parse_args(argc, argv);
+
+	std::string text;
+	if (ends_with(opt.input, ".bdf"))
+		text = font_header(opt);
+	else if (ends_with(opt.input, ".pbm") || ends_with(opt.input, ".pgm"))
+		text = bitmap_header(opt);
+	else
+		die("don't know how to convert %s", opt.input);
+
+	write_if_changed(opt.output, text);
+	if (!opt.depfile.empty())
+		write_depfile(opt);
+	return 0;
+}